@@ -0,0 +1,179 @@
+/** EeAsyncWriter.cpp ** Non-blocking commit of an EeValues record **  Oct 2026 **/
+
+#include <EeAsyncWriter.h>
+#include <EeSuperblock.h>
+
+#if EEVALUES_CONF_BACKEND == EEVALUES_BACKEND_AVR
+#include <avr/io.h>
+#include <util/atomic.h>
+#endif
+
+/* ------------------------------------------------------------------- */
+
+
+EeAsyncWriter::EeAsyncWriter( uint8_t * buffer, unsigned capacity )
+{
+    m_buffer = buffer;
+    m_capacity = capacity;
+    m_count = 0;
+    m_next = 0;
+    m_landed = false;
+    m_offset = 0;
+    m_written = 0;
+    m_skipped = 0;
+    m_on_done = NULL;
+}
+
+
+/***
+ *   Copy header and user data of 'rec' as they'd lie in EEMEM.  From here
+ *   on the record in RAM is the caller's again.
+ *
+ *   @return true if commit started.
+ */
+boolean
+EeAsyncWriter::begin( const EeValues & rec, Callback on_done )
+{
+    if( busy() || rec.totalSize() > m_capacity )
+        return( false );
+
+    memcpy( m_buffer, &rec.m_header, sizeof(rec.m_header) );
+    memcpy( m_buffer + sizeof(rec.m_header), rec.userDataPtr(), rec.userRecordSize() );
+
+    m_count = rec.totalSize();
+    m_offset = rec.eeOffsetOfHeader();
+    m_next = 0;
+    m_written = 0;
+    m_skipped = 0;
+    m_on_done = on_done;
+
+    return( true );
+}   /* end EeAsyncWriter::begin() */
+
+
+/***
+ *   Never waits for EEMEM.  If the EEPROM is still busy with the last
+ *   byte, returns straight away.  Otherwise steps over bytes that are
+ *   already right ( at most EEVALUES_ASYNC_SKIP_MAX of them ) and starts
+ *   writing the next one that isn't.  On AVR the step runs with
+ *   interrupts off, so a pollIsr() can't interleave with it.  Completion
+ *   callback runs from the poll() that finishes the commit.
+ *
+ *   @return true while commit is still in progress.
+ */
+boolean
+EeAsyncWriter::poll(void)
+{
+#if EEVALUES_CONF_BACKEND == EEVALUES_BACKEND_AVR
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE )
+#endif
+    {
+        if( m_next < m_count && EeStorage::isReady() )
+            _step();
+    }
+
+    if( m_landed )
+        _finish();
+
+    return( busy() );
+}   /* end EeAsyncWriter::poll() */
+
+
+/***
+ *   The EE_READY interrupt fires for as long as EERIE is set and the
+ *   EEPROM is idle, so EERIE is cleared once nothing is left to write.
+ *   Superblock update and callback may write EEMEM or take long ; they
+ *   wait for poll().
+ */
+void
+EeAsyncWriter::pollIsr(void)
+{
+    if( m_next < m_count && EeStorage::isReady() )
+        _step();
+
+#if EEVALUES_CONF_BACKEND == EEVALUES_BACKEND_AVR
+    if( m_next >= m_count )
+        EECR &= (uint8_t) ~_BV(EERIE);
+#endif
+}   /* end EeAsyncWriter::pollIsr() */
+
+
+boolean
+EeAsyncWriter::_stepping(void) const
+{
+    boolean  more;
+
+#if EEVALUES_CONF_BACKEND == EEVALUES_BACKEND_AVR
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE )
+#endif
+    {
+        more = m_next < m_count;
+    }
+
+    return( more );
+}
+
+
+//  Write the next byte that differs ; EEMEM must be ready.
+void
+EeAsyncWriter::_step(void)
+{
+    EE_TRACE_OP( EE_OP_WRITE );
+
+    for( uint8_t  steps = 0 ; m_next < m_count && steps < EEVALUES_ASYNC_SKIP_MAX ; ++steps )
+    {
+        const unsigned    i = _index_of( m_next++ );
+        const eeoffset_t  off = m_offset + i;
+
+        if( EeStorage::readByte( off ) != m_buffer[i] )
+        {
+            EeStorage::writeByte( off, m_buffer[i] );
+            ++m_written;
+            break;
+        }
+
+        ++m_skipped;
+    }
+
+    if( m_next >= m_count )
+        m_landed = true;
+}
+
+
+void
+EeAsyncWriter::_finish(void)
+{
+    m_landed = false;
+
+    EE_TRACE_EVENT( EE_EV_WRITE, m_offset, m_written, m_skipped );
+    _note_written();
+    if( m_on_done )
+        m_on_done( *this );
+}
+
+
+/***
+ *   CRC has landed: point the record's superblock entry here, as
+ *   EeValues::writeToEe() does.  An entry already right costs reads only ;
+ *   a new one is written in place, so that poll() does wait on EEMEM.
+ */
+void
+EeAsyncWriter::_note_written(void)
+{
+#if EEVALUES_CONF_SUPERBLOCK
+    EeValues::EeHeader  hdr;
+
+    memcpy( &hdr, m_buffer, sizeof(hdr) );
+    EeSuperblock::update( hdr.m_ident, m_offset, hdr.m_full_size );
+#endif
+}
+
+
+unsigned
+EeAsyncWriter::_index_of( unsigned n ) const
+{
+    const unsigned  crc_len = sizeof(eecrc_t);      // CRC is first in header.
+
+    //  Everything after the CRC in order, then the CRC itself.
+    return( n < m_count - crc_len ? n + crc_len : n - (m_count - crc_len) );
+}
@@ -0,0 +1,85 @@
+/** EeAsyncWriter.h ** Non-blocking commit of an EeValues record **  Oct 2026 **/
+/*
+ *  EeValues::writeToEe() busy-waits about 3.3 ms per byte, so a 40 byte
+ *  record stalls loop() for well over 100 ms.  EeAsyncWriter instead
+ *  copies header and user data into a caller-supplied buffer and returns
+ *  at once.  Each poll() then writes at most one byte, and only if the
+ *  EEPROM is idle, so no call ever waits on EEMEM.
+ *
+ *  Call poll() from loop() until done().  Bytes already holding the
+ *  right value are skipped, and the CRC is written last, so the record
+ *  doesn't validate until the commit is complete.  To write from
+ *  ISR(EE_READY_vect) instead, set EERIE after begin() and call pollIsr()
+ *  from the handler ; it clears EERIE once the CRC has landed.  poll()
+ *  must still be called from loop(): it finishes the commit outside the
+ *  ISR.  Finishing runs the on_done callback and, with
+ *  EEVALUES_CONF_SUPERBLOCK, updates the record's superblock entry ;
+ *  only a record written to a new place makes that poll() write it.
+ *
+ *  The user's record may be changed as soon as begin() returns.
+ */
+
+#ifndef _LIBRARIES_EEASYNCWRITER_H
+#define _LIBRARIES_EEASYNCWRITER_H
+
+#include "EeValues.h"
+
+/**  Most unchanged bytes one poll() will step over before returning. */
+#define EEVALUES_ASYNC_SKIP_MAX     16
+
+
+class EeAsyncWriter
+{
+   public :
+     typedef void (*Callback)( EeAsyncWriter & writer );
+
+     EeAsyncWriter( uint8_t * buffer, unsigned capacity );
+
+     //  Snapshot 'rec' ( call its updateCrc8() first ) and start writing.
+     //  Returns false if still busy or record doesn't fit in the buffer.
+     boolean  begin( const EeValues & rec, Callback on_done = NULL );
+
+     //  Write next changed byte if EEMEM is ready, and finish the commit
+     //  once it has all landed.  Returns busy().  Not from an ISR.
+     boolean  poll(void);
+
+     //  From ISR(EE_READY_vect): write next changed byte, clear EERIE
+     //  after the last.  Leaves the finish to poll().
+     void     pollIsr(void);
+
+     //  True until poll() has finished the commit.
+     boolean  busy(void) const { return _stepping() || m_landed; }
+     boolean  done(void) const { return ! busy(); }
+
+     //  Bytes actually written / skipped by the current or last commit.
+     unsigned written(void) const { return m_written; }
+     unsigned skipped(void) const { return m_skipped; }
+
+   protected :
+     uint8_t *      m_buffer;
+     unsigned       m_capacity;
+     volatile unsigned  m_count;        // bytes in snapshot.
+     volatile unsigned  m_next;         // steps taken, 0..m_count.
+     volatile boolean   m_landed;       // all written, poll() to finish.
+     eeoffset_t     m_offset;           // EE offset of snapshot[0].
+     volatile unsigned  m_written;
+     volatile unsigned  m_skipped;
+     Callback       m_on_done;
+
+     //  True while bytes are left to write ; read atomically.
+     boolean    _stepping(void) const;
+     void       _step(void);
+     void       _finish(void);
+
+     //  Snapshot index for step 'n' ; CRC bytes come last.
+     unsigned   _index_of( unsigned n ) const;
+     void       _note_written(void);
+
+   private :
+     // no implementation for these:
+     EeAsyncWriter( const EeAsyncWriter & );
+     EeAsyncWriter& operator=( const EeAsyncWriter & );
+};
+
+
+#endif
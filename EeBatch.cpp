@@ -0,0 +1,325 @@
+/** EeBatch.cpp ** Commit several records as one **  Oct 2026 **/
+
+#include <EeBatch.h>
+
+#include <string.h>
+
+/* ------------------------------------------------------------------- */
+
+//  Journal bytes are stored inverted ; see EeBatch.h.
+static void
+invert( uint8_t * p, unsigned count )
+{
+    for( ; count > 0 ; --count, ++p )
+        *p = (uint8_t) ~*p;
+}
+
+
+EeBatch::EeBatch( eeoffset_t journal, unsigned size, EeValues ** table, uint8_t capacity )
+    : m_journal( journal ), m_size( size ),
+      m_table( table ), m_capacity( capacity ), m_count( 0 )
+{
+}
+
+
+boolean
+EeBatch::add( EeValues & rec )
+{
+    for( uint8_t  i = 0 ; i < m_count ; ++i )
+        if( m_table[i] == &rec )
+            return( true );
+
+    if( m_count >= m_capacity )
+        return( false );
+
+    //  Copying the journal in place must never land on the journal.
+    const unsigned long  start = rec.eeOffsetOfHeader();
+    const unsigned long  end = start + rec.totalSize();
+
+    if( start < (unsigned long) m_journal + m_size && m_journal < end )
+        return( false );
+
+    m_table[m_count++] = &rec;
+    return( true );
+}
+
+
+unsigned
+EeBatch::needed(void)
+{
+    eecrc_t   crc = 0;
+    unsigned  written = 0;
+
+    for( uint8_t  i = 0 ; i < m_count ; ++i )
+        m_table[i]->updateCrc8();
+    _sort();
+
+    const unsigned  payload = _plan( false, &crc, &written );
+    return( payload ? EeValues::HEADER_SIZE + payload : 0 );
+}
+
+
+/***
+ *   A dry pass sizes the journal first, so a batch that doesn't fit is
+ *   refused before anything is written.  A batch left published by a
+ *   reset is then finished, so this one starts from a settled EEMEM ;
+ *   that can change what differs, so the dry pass runs again after it,
+ *   and only this batch is refused if it no longer fits.
+ *   A second pass writes the journal, and its header goes down last as
+ *   the commit marker.  From there on the batch completes the same way
+ *   recover() completes it at boot.
+ *
+ *   @return bytes written, or -1 if the changes don't fit the journal.
+ */
+int
+EeBatch::commit(void)
+{
+    EE_TRACE_OP( EE_OP_WRITE );
+
+    for( uint8_t  i = 0 ; i < m_count ; ++i )
+        m_table[i]->updateCrc8();
+    _sort();
+
+    eecrc_t   crc = 0;
+    unsigned  n = 0;
+    unsigned  payload = _plan( false, &crc, &n );
+
+    if( ! _fits( payload ) )
+        return( -1 );
+
+    unsigned  written = recover( m_journal, m_size );
+
+    if( written > 0 )
+    {
+        payload = _plan( false, &crc, &n );
+        if( ! _fits( payload ) )
+            return( -1 );
+    }
+
+    if( payload > 0 )
+    {
+        EeValues::EeHeader  hdr;
+        unsigned  same = 0;
+
+        _seal( &hdr, payload );
+        crc = EeCrc::block( EeCrc::seed(),
+                            (const uint8_t *) &hdr + sizeof(hdr.m_crc),
+                            sizeof(hdr) - sizeof(hdr.m_crc) );
+        _plan( true, &crc, &written );
+        hdr.m_crc = crc;
+
+        written += EeValues::_write_changed( m_journal, (const uint8_t *) &hdr, sizeof(hdr), &same );
+        written += recover( m_journal, m_size );
+    }
+
+    for( uint8_t  i = 0 ; i < m_count ; ++i )
+        m_table[i]->_note_written();
+
+    EE_TRACE_EVENT( EE_EV_WRITE, m_journal, written, 0 );
+    m_count = 0;
+
+    return( written );
+}   /* end EeBatch::commit() */
+
+
+/***
+ *   The journal is only trusted whole: its ident, a size that fits the
+ *   region, and a good CRC over every run.  Copying is idempotent, so a
+ *   recover() cut short by another reset just runs again.
+ *
+ *   @return bytes written.
+ */
+/* static */ int
+EeBatch::recover( eeoffset_t journal, unsigned size )
+{
+    if( EeStorage::readDword( journal + offsetof(EeValues::EeHeader, m_ident) ) != (EeIdent) JOURNAL_IDENT )
+        return( 0 );
+
+    const eesize_t  full_size = EeValues::_stored_size( journal );
+
+    if( full_size > size || ! EeValues::_is_crc_valid( journal, full_size ) )
+        return( 0 );
+
+    EE_TRACE_OP( EE_OP_WRITE );
+
+    unsigned  written = _replay( journal, full_size - EeValues::HEADER_SIZE );
+
+    EeValues  marker( JOURNAL_IDENT );
+    marker.setEeOffset( journal );
+    written += marker.invalidate();
+
+    return( written );
+}   /* end EeBatch::recover() */
+
+/* ------------------------------------------------------------------- */
+
+//  Journal region holds 'payload' bytes of runs as one record?
+boolean
+EeBatch::_fits( unsigned payload ) const
+{
+    return( payload == 0 ||
+            ( EeValues::HEADER_SIZE + payload <= m_size &&
+              EeValues::HEADER_SIZE + payload <= EEVALUES_MAX_FULL_SIZE &&
+              (unsigned long) m_journal + m_size <= EeStorage::size() ) );
+}
+
+
+//  Table into address order ; a handful of records, so insertion sort.
+void
+EeBatch::_sort(void)
+{
+    for( uint8_t  i = 1 ; i < m_count ; ++i )
+    {
+        EeValues *  rec = m_table[i];
+        uint8_t     j = i;
+
+        for( ; j > 0 && m_table[j - 1]->eeOffsetOfHeader() > rec->eeOffsetOfHeader() ; --j )
+            m_table[j] = m_table[j - 1];
+        m_table[j] = rec;
+    }
+}
+
+
+//  Runs of every record, in table order.  Returns the payload size.
+unsigned
+EeBatch::_plan( boolean write, eecrc_t * crc, unsigned * written )
+{
+    unsigned  pos = 0;
+
+    for( uint8_t  i = 0 ; i < m_count ; ++i )
+    {
+        EeValues &  rec = *m_table[i];
+
+        _diff( rec.eeOffsetOfHeader(), (const uint8_t *) &rec.m_header, EeValues::HEADER_SIZE,
+               write, &pos, crc, written );
+        _diff( rec.eeOffsetOfUserRecord(), (const uint8_t *) rec.userDataPtr(), rec.userRecordSize(),
+               write, &pos, crc, written );
+    }
+
+    return( pos );
+}
+
+
+/***
+ *   Runs of 'src' that differ from EEMEM at 'dst', appended to the
+ *   journal at '*pos', or just counted when 'write' is false.  A gap of
+ *   equal bytes shorter than a run head is cheaper carried inside the
+ *   run ; copying it back in place then costs reads only.
+ */
+void
+EeBatch::_diff( eeoffset_t dst, const uint8_t * src, unsigned count,
+                boolean write, unsigned * pos, eecrc_t * crc, unsigned * written )
+{
+    unsigned  i = 0;
+
+    while( i < count )
+    {
+        if( EeStorage::readByte( dst + i ) == src[i] )
+        {
+            ++i;
+            continue;
+        }
+
+        unsigned  end = i + 1;
+
+        for( unsigned  j = end ; j < count && j - i < 0xFF ; ++j )
+        {
+            if( EeStorage::readByte( dst + j ) != src[j] )
+                end = j + 1;
+            else if( j + 1 - end >= sizeof(EeBatchRun) )
+                break;
+        }
+
+        EeBatchRun  run;
+        run.m_offset = dst + i;
+        run.m_length = (uint8_t) (end - i);
+
+        _emit( (const uint8_t *) &run, sizeof(run), write, pos, crc, written );
+        _emit( src + i, end - i, write, pos, crc, written );
+        i = end;
+    }
+}
+
+
+void
+EeBatch::_emit( const uint8_t * src, unsigned count,
+                boolean write, unsigned * pos, eecrc_t * crc, unsigned * written )
+{
+    if( ! write )
+    {
+        *pos += count;
+        return;
+    }
+
+    uint8_t   chunk[16];
+    unsigned  same = 0;
+
+    while( count > 0 )
+    {
+        const unsigned  n = count < sizeof(chunk) ? count : sizeof(chunk);
+
+        memcpy( chunk, src, n );
+        invert( chunk, n );
+        *crc = EeCrc::block( *crc, chunk, n );
+        *written += EeValues::_write_changed( m_journal + EeValues::HEADER_SIZE + *pos, chunk, n, &same );
+
+        *pos += n;
+        src += n;
+        count -= n;
+    }
+}
+
+
+//  Journal header for 'payload' bytes of runs, CRC not yet set.
+/* static */ void
+EeBatch::_seal( EeValues::EeHeader * hdr, unsigned payload )
+{
+    hdr->m_crc = 0;
+#if _EEVALUES_HDR_FORMAT
+    hdr->m_format = _EEVALUES_FORMAT;
+#endif
+#if EEVALUES_CONF_SCHEMA
+    hdr->m_schema = 0;
+#endif
+    hdr->m_full_size = (eesize_t) (EeValues::HEADER_SIZE + payload);
+    hdr->m_ident = JOURNAL_IDENT;
+}
+
+
+//  Copy every run of the journal in place, skipping bytes already right.
+/* static */ unsigned
+EeBatch::_replay( eeoffset_t journal, unsigned payload )
+{
+    unsigned long        at = journal + EeValues::HEADER_SIZE;
+    const unsigned long  end = at + payload;
+    unsigned             written = 0;
+    unsigned             same = 0;
+    uint8_t              chunk[16];
+
+    while( at + sizeof(EeBatchRun) <= end )
+    {
+        EeBatchRun  run;
+
+        EeStorage::readBlock( &run, (eeoffset_t) at, sizeof(run) );
+        invert( (uint8_t *) &run, sizeof(run) );
+        at += sizeof(run);
+
+        if( at + run.m_length > end ||
+            (unsigned long) run.m_offset + run.m_length > EeStorage::size() )
+            break;
+
+        for( unsigned  done = 0 ; done < run.m_length ; )
+        {
+            const unsigned  n = run.m_length - done < sizeof(chunk) ? run.m_length - done : sizeof(chunk);
+
+            EeStorage::readBlock( chunk, (eeoffset_t) (at + done), n );
+            invert( chunk, n );
+            written += EeValues::_write_changed( run.m_offset + done, chunk, n, &same );
+            done += n;
+        }
+
+        at += run.m_length;
+    }
+
+    return( written );
+}   /* end EeBatch::_replay() */
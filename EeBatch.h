@@ -0,0 +1,107 @@
+/** EeBatch.h ** Commit several records as one **  Oct 2026 **/
+/*
+ *  Saving settings often means several records in a row, each with its
+ *  own updateCrc8() and writeToEe().  Every byte of each goes out, and
+ *  power lost part way leaves some records new and some old.  EeBatch
+ *  gathers the records and commits them together:
+ *
+ *      EeValues *  recs[ 4 ];
+ *      EeBatch     batch( 900, 100, recs, 4 );
+ *
+ *      EeBatch::recover( 900, 100 );       // at boot, before any load
+ *      ...
+ *      batch.add( ident );  batch.add( net );  batch.add( cal );
+ *      batch.commit();
+ *
+ *  commit() runs updateCrc8() on each record, then walks them in address
+ *  order and notes each run of bytes that differs from EEMEM.  Those runs
+ *  are written to a journal -- one record of ident "EeBJ" in a region of
+ *  its own -- and the journal's header, written last, is the single
+ *  commit marker for the group.  Then the runs are copied in place, again
+ *  in address order and skipping bytes already right, and the journal is
+ *  retired with one byte.  Unchanged bytes cost reads only, so a save
+ *  that touches a few fields writes far less than a writeToEe() each ;
+ *  eebench's 'batch' lines give figures.
+ *
+ *  Power lost before the marker is down leaves every record old ; after
+ *  it, recover() finds the journal and finishes copying, so every record
+ *  is new.  Call recover() at boot before loading any record that is
+ *  ever saved in a batch.  Journal bytes are stored inverted, so a
+ *  findHeader() hunting over the journal can't mistake a copied record
+ *  for the real one.  The journal must not overlap the records -- add()
+ *  refuses one that does -- and all changed bytes of a batch, plus 3
+ *  bytes a run ( 5 with LARGE ), must fit it as a single record: below
+ *  EEVALUES_MAX_FULL_SIZE.
+ */
+
+#ifndef _LIBRARIES_EEBATCH_H
+#define _LIBRARIES_EEBATCH_H
+
+#include "EeValues.h"
+
+
+//  Head of one run in the journal, followed by 'm_length' bytes.
+struct PACKED EeBatchRun
+{
+     eeoffset_t    m_offset;           // where the bytes go in EEMEM
+     uint8_t       m_length;
+};
+
+
+class EeBatch
+{
+   public :
+     enum { JOURNAL_IDENT = MK4CODE('E','e','B','J') };
+
+     //  Journal lives in 'size' bytes of EEMEM from 'journal' ; the table
+     //  of 'capacity' record pointers is the caller's RAM.
+     EeBatch( eeoffset_t journal, unsigned size, EeValues ** table, uint8_t capacity );
+
+     //  Add 'rec', with its user data pointer, size and offset set, to the
+     //  next commit.  Adding it again is harmless.  False if table is full
+     //  or the record overlaps the journal.
+     boolean   add( EeValues & rec );
+
+     //  Drop all records without writing.
+     void      clear(void) { m_count = 0; }
+     uint8_t   count(void) const { return m_count; }
+
+     //  Journal bytes the next commit() would need, header included ;
+     //  0 if no record has changed.
+     unsigned  needed(void);
+
+     //  Finish any batch left by a reset, as recover(), then seal, journal
+     //  and write all records, and clear the batch.  Returns bytes written,
+     //  journal included, or -1 if the changes don't fit the journal: no
+     //  byte of this batch is then written, and it is kept.
+     int       commit(void);
+
+     //  Finish a batch whose commit marker is down.  Returns bytes
+     //  written, 0 if there was nothing to finish.
+     static int   recover( eeoffset_t journal, unsigned size );
+
+   protected :
+     eeoffset_t     m_journal;
+     unsigned       m_size;
+     EeValues **    m_table;
+     uint8_t        m_capacity;
+     uint8_t        m_count;
+
+     boolean          _fits( unsigned payload ) const;
+     void             _sort(void);
+     unsigned         _plan( boolean write, eecrc_t * crc, unsigned * written );
+     void             _diff( eeoffset_t dst, const uint8_t * src, unsigned count,
+                             boolean write, unsigned * pos, eecrc_t * crc, unsigned * written );
+     void             _emit( const uint8_t * src, unsigned count,
+                             boolean write, unsigned * pos, eecrc_t * crc, unsigned * written );
+     static void      _seal( EeValues::EeHeader * hdr, unsigned payload );
+     static unsigned  _replay( eeoffset_t journal, unsigned payload );
+
+   private :
+     // no implementation for these:
+     EeBatch( const EeBatch & );
+     EeBatch& operator=( const EeBatch & );
+};
+
+
+#endif
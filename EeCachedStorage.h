@@ -0,0 +1,123 @@
+/** EeCachedStorage.h ** Small RAM read cache in front of a back-end **  Oct 2026 **/
+/*
+ *  Code that reads a record a byte at a time, or _find_ident() reading a
+ *  byte and then an overlapping dword at each offset, asks EEMEM for the
+ *  same bytes again and again.  EeCachedStorage< BASE, LINE, LINES > keeps
+ *  LINES direct-mapped lines of LINE bytes in RAM and serves such reads
+ *  from there.  RAM cost is LINES * (LINE + 3) bytes on AVR.  EEMEM size
+ *  must be a multiple of LINE, which it is for any power of 2 up to it.
+ *
+ *  Writes and fills go straight through to BASE and update any cached
+ *  copy of the bytes, so the cache never serves stale data written via
+ *  EeValues.  Anything that changes EEMEM behind the library's back must
+ *  call invalidate().
+ *
+ *  hits() and misses() help size LINE and LINES for the RAM budget.
+ *  Everything else a back-end offers ( e.g. EeMmapStorage::open() ) is
+ *  inherited from BASE.
+ */
+
+#ifndef _LIBRARIES_EECACHEDSTORAGE_H
+#define _LIBRARIES_EECACHEDSTORAGE_H
+
+
+template< class BASE, unsigned LINE, unsigned LINES >
+struct EeCachedStorage : public BASE
+{
+     static_assert( LINE > 0 && (LINE & (LINE - 1)) == 0, "EeCachedStorage: line size must be a power of 2" );
+     static_assert( LINES > 0, "EeCachedStorage: need at least one line" );
+
+     static uint8_t   readByte( eeoffset_t off )
+                        { return _line( off )[ off % LINE ]; }
+     static uint32_t  readDword( eeoffset_t off )
+                        { uint32_t v; readBlock( &v, off, sizeof(v) ); return v; }
+     static void      readBlock( void * dst, eeoffset_t off, size_t n )
+                        {
+                            uint8_t *  d = (uint8_t *) dst;
+
+                            while( n > 0 )
+                            {
+                                size_t  chunk = LINE - (off % LINE);
+                                if( chunk > n )
+                                    chunk = n;
+
+                                memcpy( d, _line( off ) + (off % LINE), chunk );
+                                d += chunk;
+                                off += chunk;
+                                n -= chunk;
+                            }
+                        }
+
+     static void      writeByte( eeoffset_t off, uint8_t value )
+                        {
+                            BASE::writeByte( off, value );
+                            _update( off, &value, 0, 1 );
+                        }
+     static void      writeBlock( eeoffset_t off, const void * src, size_t n )
+                        {
+                            BASE::writeBlock( off, src, n );
+                            _update( off, (const uint8_t *) src, 0, n );
+                        }
+     static void      fill( eeoffset_t off, uint8_t value, size_t n )
+                        {
+                            BASE::fill( off, value, n );
+                            _update( off, NULL, value, n );
+                        }
+
+     static void      invalidate(void) { memset( s_valid, 0, sizeof(s_valid) ); }
+
+     static unsigned long  hits(void) { return s_hits; }
+     static unsigned long  misses(void) { return s_misses; }
+     static void      resetCacheCounters(void) { s_hits = s_misses = 0; }
+
+     //  Return cached line holding 'off', filling it on a miss.
+     static const uint8_t *  _line( eeoffset_t off )
+                        {
+                            const eeoffset_t  tag = off / LINE;
+                            const unsigned    idx = tag % LINES;
+
+                            if( s_valid[idx] && s_tag[idx] == tag )
+                            {
+                                ++s_hits;
+                            }
+                            else
+                            {
+                                ++s_misses;
+                                BASE::readBlock( s_data[idx], tag * LINE, LINE );
+                                s_tag[idx] = tag;
+                                s_valid[idx] = true;
+                            }
+
+                            return( s_data[idx] );
+                        }
+
+     //  Write-through: patch bytes of any line that is cached.
+     static void      _update( eeoffset_t off, const uint8_t * src, uint8_t value, size_t n )
+                        {
+                            for( ; n > 0 ; --n, ++off )
+                            {
+                                const eeoffset_t  tag = off / LINE;
+                                const unsigned    idx = tag % LINES;
+
+                                if( s_valid[idx] && s_tag[idx] == tag )
+                                    s_data[idx][off % LINE] = src ? *src : value;
+                                if( src )
+                                    ++src;
+                            }
+                        }
+
+     static uint8_t        s_data[ LINES ][ LINE ];
+     static eeoffset_t     s_tag[ LINES ];
+     static boolean        s_valid[ LINES ];
+     static unsigned long  s_hits;
+     static unsigned long  s_misses;
+};
+
+template< class B, unsigned L, unsigned N > uint8_t        EeCachedStorage< B, L, N >::s_data[ N ][ L ];
+template< class B, unsigned L, unsigned N > eeoffset_t     EeCachedStorage< B, L, N >::s_tag[ N ];
+template< class B, unsigned L, unsigned N > boolean        EeCachedStorage< B, L, N >::s_valid[ N ];
+template< class B, unsigned L, unsigned N > unsigned long  EeCachedStorage< B, L, N >::s_hits;
+template< class B, unsigned L, unsigned N > unsigned long  EeCachedStorage< B, L, N >::s_misses;
+
+
+#endif
@@ -0,0 +1,477 @@
+/** EeCompressed.cpp ** Run-length coded EEMEM record **  Oct 2026 **/
+
+#include <EeCompressed.h>
+
+#include <string.h>
+
+#define RLE_RUN_MIN     3                       // shorter runs go as literals
+#define RLE_RUN_MAX     (0x7F + RLE_RUN_MIN)
+#define RLE_LIT_MAX     0x80
+
+/* ------------------------------------------------------------------- */
+
+//  Output sinks for _encode(), input sources for _decode().
+
+struct EeCompressed::_Counter
+{
+    unsigned    n;
+    void        operator()( uint8_t ) { ++n; }
+};
+
+struct EeCompressed::_Crc
+{
+    eecrc_t     crc;
+    void        operator()( uint8_t b ) { crc = EeCrc::update( crc, b ); }
+};
+
+//  Batches output so a paged back-end sees block writes, not bytes.
+struct EeCompressed::_EeWriter
+{
+    eeoffset_t  off;
+    boolean     changed_only;
+    unsigned    written;
+    unsigned    skipped;
+    uint8_t     fill;
+    uint8_t     buf[16];
+
+    void        operator()( uint8_t b )
+                    {
+                        buf[fill++] = b;
+                        if( fill == sizeof(buf) )
+                            flush();
+                    }
+    void        flush(void)
+                    {
+                        if( changed_only )
+                        {
+                            written += _write_changed( off, buf, fill, &skipped );
+                        }
+                        else
+                        {
+                            EeStorage::writeBlock( off, buf, fill );
+                            written += fill;
+                        }
+                        off += fill;
+                        fill = 0;
+                    }
+};
+
+struct EeCompressed::_RamReader
+{
+    const uint8_t *  p;
+    uint8_t     next(void) { return *p++; }
+};
+
+//  Reads ahead a few bytes at a time, updating CRC as bytes are taken.
+struct EeCompressed::_EeReader
+{
+    eeoffset_t  off;
+    unsigned    left;
+    eecrc_t     crc;
+    uint8_t     pos;
+    uint8_t     have;
+    uint8_t     buf[16];
+
+    uint8_t     next(void)
+                    {
+                        if( pos == have )
+                        {
+                            have = left < sizeof(buf) ? left : sizeof(buf);
+                            EeStorage::readBlock( buf, off, have );
+                            off += have;
+                            left -= have;
+                            pos = 0;
+                        }
+                        crc = EeCrc::update( crc, buf[pos] );
+                        return( buf[pos++] );
+                    }
+};
+
+/* ------------------------------------------------------------------- */
+
+
+EeCompressed::EeCompressed( EeIdent id )
+    : EeValues( id )
+{
+    m_raw_size = 0;
+    m_codec = EE_CODEC_NONE;
+}
+
+
+/***
+ *   Emit the run-length code of 'n' bytes at 'src' to 'out'.  A run of
+ *   RLE_RUN_MIN or more equal bytes is a control byte and the value ;
+ *   anything else gathers into a literal block, ended by the next run.
+ */
+template< class OUT >
+/* static */ void
+EeCompressed::_encode( const uint8_t * src, unsigned n, OUT & out )
+{
+    unsigned  i = 0;
+
+    while( i < n )
+    {
+        unsigned  run = 1;
+        while( i + run < n && run < RLE_RUN_MAX && src[i + run] == src[i] )
+            ++run;
+
+        if( run >= RLE_RUN_MIN )
+        {
+            out( (uint8_t) (0x80 | (run - RLE_RUN_MIN)) );
+            out( src[i] );
+            i += run;
+            continue;
+        }
+
+        unsigned  lit = 0;
+        while( i + lit < n && lit < RLE_LIT_MAX )
+        {
+            if( i + lit + 2 < n && src[i + lit] == src[i + lit + 1] && src[i + lit] == src[i + lit + 2] )
+                break;
+            ++lit;
+        }
+
+        out( (uint8_t) (lit - 1) );
+        for( unsigned  k = 0 ; k < lit ; ++k )
+            out( src[i + k] );
+        i += lit;
+    }
+}   /* end EeCompressed::_encode() */
+
+
+/***
+ *   Decode 'n' coded bytes taken from 'in' into 'dst'.
+ *   @return bytes decoded, or -1 if the code is malformed or overruns.
+ */
+template< class IN >
+/* static */ int
+EeCompressed::_decode( IN & in, unsigned n, uint8_t * dst, unsigned dst_size )
+{
+    unsigned  out = 0;
+
+    while( n > 0 )
+    {
+        const uint8_t  c = in.next();
+        --n;
+
+        if( c & 0x80 )
+        {
+            const unsigned  run = (c & 0x7F) + RLE_RUN_MIN;
+
+            if( n < 1 || out + run > dst_size )
+                return( -1 );
+
+            memset( dst + out, in.next(), run );
+            --n;
+            out += run;
+        }
+        else
+        {
+            const unsigned  lit = c + 1;
+
+            if( n < lit || out + lit > dst_size )
+                return( -1 );
+
+            for( unsigned  k = 0 ; k < lit ; ++k )
+                dst[out++] = in.next();
+            n -= lit;
+        }
+    }
+
+    return( (int) out );
+}   /* end EeCompressed::_decode() */
+
+
+/* static */ unsigned
+EeCompressed::rleEncode( const uint8_t * src, unsigned n, uint8_t * dst )
+{
+    if( dst == NULL )
+    {
+        _Counter  cnt = { 0 };
+        _encode( src, n, cnt );
+        return( cnt.n );
+    }
+
+    struct _RamWriter
+    {
+        uint8_t *  p;
+        void       operator()( uint8_t b ) { *p++ = b; }
+    } w = { dst };
+
+    _encode( src, n, w );
+    return( (unsigned) (w.p - dst) );
+}
+
+
+/* static */ int
+EeCompressed::rleDecode( const uint8_t * src, unsigned n, uint8_t * dst, unsigned dst_size )
+{
+    _RamReader  in = { src };
+
+    return( _decode( in, n, dst, dst_size ) );
+}
+
+/* ------------------------------------------------------------------- */
+
+/***
+ *   Decide the codec, set the stored size to match, and compute the CRC
+ *   over header, pack info and payload as they will sit in EEMEM.  The
+ *   record is coded twice here and again when written, trading some
+ *   CPU for not needing a RAM buffer the size of the record.
+ */
+void
+EeCompressed::updateCrc8()
+{
+    const uint8_t *  user = (const uint8_t *) userDataPtr();
+    _Counter         cnt = { 0 };
+
+    _encode( user, m_raw_size, cnt );
+    m_codec = cnt.n < m_raw_size ? EE_CODEC_RLE : EE_CODEC_NONE;
+
+    const unsigned  full_size = sizeof(EeHeader) + sizeof(EePackInfo) +
+                                (m_codec == EE_CODEC_RLE ? cnt.n : m_raw_size);
+    if( full_size > EEVALUES_MAX_FULL_SIZE )
+    {
+        m_header.m_full_size = 0;
+        return;
+    }
+    m_header.m_full_size = (eesize_t) full_size;
+
+    EePackInfo  info;
+    info.m_codec = m_codec;
+    info.m_raw_size = m_raw_size;
+
+    _Crc  c;
+    c.crc = EeCrc::block( EeCrc::seed(),
+                          (const uint8_t *) &this->m_header + sizeof(m_header.m_crc),
+                          sizeof(this->m_header) - sizeof(m_header.m_crc) );
+    c.crc = EeCrc::block( c.crc, (const uint8_t *) &info, sizeof(info) );
+
+    if( m_codec == EE_CODEC_RLE )
+        _encode( user, m_raw_size, c );
+    else
+        c.crc = EeCrc::block( c.crc, user, m_raw_size );
+
+    setCrc8( c.crc );
+}   /* end EeCompressed::updateCrc8() */
+
+
+int
+EeCompressed::writeToEe(void)
+{
+    return( _write( false, NULL ) );
+}
+
+
+int
+EeCompressed::writeChangedToEe( unsigned * skipped )
+{
+    return( _write( true, skipped ) );
+}
+
+
+/***
+ *   Payload and pack info first, header with its CRC last, so a record
+ *   torn part way through fails its CRC.
+ *
+ *   @return count of bytes written, -1 if updateCrc8() found it too big.
+ */
+int
+EeCompressed::_write( boolean changed_only, unsigned * skipped )
+{
+    if( totalSize() == 0 )
+        return( -1 );
+
+    EE_TRACE_OP( EE_OP_WRITE );
+
+    const uint8_t *  user = (const uint8_t *) userDataPtr();
+    _EeWriter        w;
+
+    w.off = eeOffsetOfUserRecord();
+    w.changed_only = changed_only;
+    w.written = 0;
+    w.skipped = 0;
+    w.fill = 0;
+
+    if( m_codec == EE_CODEC_RLE )
+    {
+        _encode( user, m_raw_size, w );
+    }
+    else
+    {
+        for( unsigned  i = 0 ; i < m_raw_size ; ++i )
+            w( user[i] );
+    }
+    w.flush();
+
+    EePackInfo  info;
+    info.m_codec = m_codec;
+    info.m_raw_size = m_raw_size;
+
+    w.off = eeOffsetOfPackInfo();
+    for( unsigned  i = 0 ; i < sizeof(info) ; ++i )
+        w( ((const uint8_t *) &info)[i] );
+    w.flush();
+
+    w.off = eeOffsetOfHeader();
+    for( unsigned  i = 0 ; i < sizeof(this->m_header) ; ++i )
+        w( ((const uint8_t *) &this->m_header)[i] );
+    w.flush();
+
+    EE_TRACE_EVENT( EE_EV_WRITE, eeOffsetOfHeader(), w.written, w.skipped );
+    _note_written();
+
+    if( skipped )
+        *skipped = w.skipped;
+
+    return( (int) w.written );
+}   /* end EeCompressed::_write() */
+
+/* ------------------------------------------------------------------- */
+
+#if EEVALUES_CONF_HUNT_FOR_RECORD
+
+boolean
+EeCompressed::findHeader()
+{
+    if( ! _find_ident( true ) )
+        return( false );
+
+    return( _check_pack_info() );
+}   /* end EeCompressed::findHeader() */
+
+#endif
+
+
+/***
+ *   As EeValues::isHeaderValid(), but the size comes from EEMEM since it
+ *   follows the data.  The pack info must agree with setUserSize().
+ */
+boolean
+EeCompressed::isHeaderValid(void)
+{
+    EE_TRACE_OP( EE_OP_FIND );
+
+    const eeoffset_t  base = eeOffsetOfHeader();
+
+    if( EeStorage::readDword( base + offsetof(EeHeader, m_ident) ) != ident() )
+        return( false );
+
+    const eesize_t  full_size = _stored_size( base );
+
+    if( ! _is_crc_valid( base, full_size ) )
+        return( false );
+
+    m_header.m_full_size = full_size;
+    return( _check_pack_info() );
+}   /* end EeCompressed::isHeaderValid() */
+
+
+//  Pack info at eeOffsetOfPackInfo() is sane and matches our RAM size?
+boolean
+EeCompressed::_check_pack_info(void)
+{
+    if( totalSize() < sizeof(EeHeader) + sizeof(EePackInfo) )
+        return( false );
+
+    EePackInfo  info;
+    EeStorage::readBlock( &info, eeOffsetOfPackInfo(), sizeof(info) );
+
+    if( info.m_raw_size != m_raw_size )
+        return( false );
+    if( info.m_codec != EE_CODEC_RLE &&
+        ! (info.m_codec == EE_CODEC_NONE && _payload_size() == m_raw_size) )
+        return( false );
+
+    m_codec = info.m_codec;
+    return( true );
+}
+
+
+int
+EeCompressed::readToUser(void)
+{
+    EE_TRACE_OP( EE_OP_LOAD );
+
+    if( m_codec == EE_CODEC_NONE )
+    {
+        EeStorage::readBlock( userDataPtr(), eeOffsetOfUserRecord(), m_raw_size );
+        return( m_raw_size );
+    }
+
+    _EeReader  in;
+    in.off = eeOffsetOfUserRecord();
+    in.left = _payload_size();
+    in.crc = 0;
+    in.pos = in.have = 0;
+
+    if( _decode( in, _payload_size(), (uint8_t *) userDataPtr(), m_raw_size ) != (int) m_raw_size )
+        return( -1 );
+
+    return( m_raw_size );
+}   /* end EeCompressed::readToUser() */
+
+
+/***
+ *   Check header and pack info, then decode straight from EEMEM into the
+ *   user's buffer while the CRC runs over the stored bytes.  Each stored
+ *   byte is read once.
+ *
+ *   @return true if header matches ( ident, format, and schema if
+ *           stored ), record decodes to setUserSize() bytes and CRC is good.
+ */
+boolean
+EeCompressed::loadIfValid(void)
+{
+    EE_TRACE_OP( EE_OP_LOAD );
+
+    EeHeader  hdr;
+    EeStorage::readBlock( &hdr, m_start_offset, sizeof(hdr) );
+
+    if( hdr.m_ident != m_header.m_ident ||
+        (unsigned long) m_start_offset + hdr.m_full_size > EeStorage::size() )
+        return( false );
+#if _EEVALUES_HDR_FORMAT
+    if( hdr.m_format != _EEVALUES_FORMAT )
+        return( false );
+#endif
+#if EEVALUES_CONF_SCHEMA
+    if( hdr.m_schema != m_header.m_schema )
+        return( false );
+#endif
+
+    m_header.m_full_size = hdr.m_full_size;
+    m_header.m_crc = hdr.m_crc;
+
+    if( ! _check_pack_info() )
+        return( false );
+
+    EePackInfo  info;
+    EeStorage::readBlock( &info, eeOffsetOfPackInfo(), sizeof(info) );
+
+    eecrc_t  crc = EeCrc::block( EeCrc::seed(),
+                                 (const uint8_t *) &hdr + sizeof(hdr.m_crc),
+                                 sizeof(hdr) - sizeof(hdr.m_crc) );
+    crc = EeCrc::block( crc, (const uint8_t *) &info, sizeof(info) );
+
+    if( m_codec == EE_CODEC_NONE )
+    {
+        EeStorage::readBlock( userDataPtr(), eeOffsetOfUserRecord(), m_raw_size );
+        crc = EeCrc::block( crc, (const uint8_t *) userDataPtr(), m_raw_size );
+    }
+    else
+    {
+        _EeReader  in;
+        in.off = eeOffsetOfUserRecord();
+        in.left = _payload_size();
+        in.crc = crc;
+        in.pos = in.have = 0;
+
+        if( _decode( in, _payload_size(), (uint8_t *) userDataPtr(), m_raw_size ) != (int) m_raw_size )
+            return( false );
+        crc = in.crc;
+    }
+
+    EE_TRACE_EVENT( EE_EV_LOAD, m_start_offset, m_raw_size, crc == m_header.m_crc );
+    return( crc == m_header.m_crc );
+}   /* end EeCompressed::loadIfValid() */
@@ -0,0 +1,117 @@
+/** EeCompressed.h ** Run-length coded EEMEM record **  Oct 2026 **/
+/*
+ *  Pin maps and calibration tables are mostly runs of 0xFF ( unused ) or
+ *  0x00.  EeCompressed run-length codes the user's record on the way to
+ *  EEMEM and decodes it on the way back, so such a record takes fewer
+ *  EEMEM bytes and a commit writes fewer of the slow 3.3 ms bytes.
+ *
+ *  Stored as:
+ *      EeHeader     m_full_size is the size as STORED, not the RAM size
+ *      EePackInfo   codec ( EE_CODEC_RLE or EE_CODEC_NONE ) and RAM size
+ *      payload      coded bytes, or the raw bytes when coding didn't help
+ *  The CRC covers all three, so EeDirectory and the ident scan see an
+ *  ordinary record.
+ *
+ *  Code: a control byte 'c' below 0x80 is followed by c + 1 literal
+ *  bytes ; 0x80 and up by one byte to repeat (c & 0x7F) + 3 times.  At
+ *  worst that grows data by a byte in 128, in which case it is stored raw.
+ *
+ *      EeCompressed  pins( MK4CODE('P','I','N','S') );
+ *      pins.setUserDataPtr( &cfg );
+ *      pins.setUserSize( sizeof(cfg) );
+ *      if( ! pins.findHeader() || ! pins.loadIfValid() ) { ...defaults... }
+ *      ...
+ *      pins.updateCrc8();              // codes the record, sets stored size
+ *      pins.writeChangedToEe();
+ *
+ *  Stored size follows the data, so space reserved for the record must
+ *  be maxStoredSize().  A record larger than 255 bytes in RAM is fine as
+ *  long as it codes down to fit ; if not, updateCrc8() leaves totalSize()
+ *  at 0 and the writes return -1.
+ *
+ *  Use EeCompressed's own setUserSize(), userRecordSize(), updateCrc8(),
+ *  write, read and find methods ; the EeValues versions don't decode.
+ */
+
+#ifndef _LIBRARIES_EECOMPRESSED_H
+#define _LIBRARIES_EECOMPRESSED_H
+
+#include "EeValues.h"
+
+enum { EE_CODEC_NONE = 0, EE_CODEC_RLE = 1 };
+
+
+class EeCompressed : public EeValues
+{
+   public :
+     EeCompressed( EeIdent id );
+
+     //  Size of the user's record in RAM, before coding.
+     //  False, and size left as it was, if it exceeds the pack info's 16 bits.
+     boolean    setUserSize( unsigned siz )
+     {
+         if( (unsigned long) siz > 0xFFFFUL )
+             return( false );
+         m_raw_size = (uint16_t) siz;
+         return( true );
+     }
+     unsigned   userRecordSize(void) const { return m_raw_size; }
+
+     //  Codec chosen by the last updateCrc8(), or found by a load.
+     uint8_t    codec(void) const { return m_codec; }
+
+     //  EEMEM to reserve: header, pack info and the record stored raw.
+     unsigned   maxStoredSize(void) const { return sizeof(EeHeader) + sizeof(EePackInfo) + m_raw_size; }
+
+#if EEVALUES_CONF_HUNT_FOR_RECORD
+     boolean    findHeader();
+#endif
+     boolean    isHeaderValid(void);
+
+     //  Code the record, set stored size and compute CRC over what will be stored.
+     void       updateCrc8();
+
+     int        writeToEe(void);
+     int        writeChangedToEe( unsigned * skipped = NULL );
+
+     //  Decode into setUserDataPtr() without checking CRC.  -1 if malformed.
+     int        readToUser(void);
+
+     //  Header check, decode and CRC check in one pass over EEMEM.
+     boolean    loadIfValid(void);
+
+     //  RAM to RAM coding.  'dst' NULL just counts.  Decode returns -1
+     //  if 'src' is malformed or would overrun 'dst_size'.
+     static unsigned  rleEncode( const uint8_t * src, unsigned n, uint8_t * dst );
+     static int       rleDecode( const uint8_t * src, unsigned n, uint8_t * dst, unsigned dst_size );
+
+   protected :
+     struct PACKED EePackInfo {
+        uint8_t        m_codec;
+        uint16_t       m_raw_size;
+     };
+
+     uint16_t       m_raw_size;
+     uint8_t        m_codec;
+
+     eeoffset_t  eeOffsetOfPackInfo(void) const { return eeOffsetOfHeader() + sizeof(EeHeader); }
+     eeoffset_t  eeOffsetOfUserRecord(void) const { return eeOffsetOfPackInfo() + sizeof(EePackInfo); }
+
+     unsigned   _payload_size(void) const { return totalSize() - sizeof(EeHeader) - sizeof(EePackInfo); }
+     boolean    _check_pack_info(void);
+     int        _write( boolean changed_only, unsigned * skipped );
+
+     template< class IN >
+     static int   _decode( IN & in, unsigned n, uint8_t * dst, unsigned dst_size );
+     template< class OUT >
+     static void  _encode( const uint8_t * src, unsigned n, OUT & out );
+
+     struct _Counter;
+     struct _Crc;
+     struct _EeWriter;
+     struct _RamReader;
+     struct _EeReader;
+};
+
+
+#endif
@@ -0,0 +1,139 @@
+/** EeCrc.h ** Compile-time selectable CRC engines for EeValues **  Oct 2026 **/
+/*
+ *  Every CRC EeValues computes goes through 'EeCrc', picked at compile
+ *  time by EEVALUES_CONF_CRC.  Each engine is a specialisation of
+ *  EeCrcEngine<> with static inline update() and block(), so there is no
+ *  call overhead over using a CRC function directly.
+ *
+ *  EEVALUES_CRC8_LIB      bitwise Crc8() of the crc8 library.  Default,
+ *                         and the only one that keeps the original
+ *                         6 byte header, so old EEMEM images still match.
+ *  EEVALUES_CRC8_NIBBLE   Dallas/Maxim CRC-8 ( reflected 0x8C ), two
+ *                         look-ups in a 16 byte PROGMEM table per byte.
+ *  EEVALUES_CRC8_TABLE    same CRC-8, one look-up in 256 bytes of PROGMEM.
+ *  EEVALUES_CRC16_CCITT   CRC-16-CCITT, as _crc_ccitt_update() of avr-libc.
+ *
+ *  With anything but EEVALUES_CRC8_LIB, the header gains a format byte
+ *  holding the header version and the CRC kind, and a record only
+ *  matches if it was written with the same kind.
+ */
+
+#ifndef _LIBRARIES_EECRC_H
+#define _LIBRARIES_EECRC_H
+
+#define EEVALUES_CRC8_LIB       0
+#define EEVALUES_CRC8_NIBBLE    1
+#define EEVALUES_CRC8_TABLE     2
+#define EEVALUES_CRC16_CCITT    3
+
+#ifndef EEVALUES_CONF_CRC
+#define EEVALUES_CONF_CRC       EEVALUES_CRC8_LIB
+#endif
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+#else
+#define PROGMEM
+#define pgm_read_byte(_addr)    (*(const uint8_t *)(_addr))
+#define memcpy_P(_dst, _src, _n)    memcpy( (_dst), (_src), (_n) )
+#endif
+
+#if EEVALUES_CONF_CRC == EEVALUES_CRC8_LIB
+#include <crc8.h>
+#endif
+
+
+/* ------------------------------------------------------------------- */
+
+template< uint8_t KIND > struct EeCrcEngine;
+
+#if EEVALUES_CONF_CRC == EEVALUES_CRC8_LIB
+template<> struct EeCrcEngine< EEVALUES_CRC8_LIB >
+{
+     typedef uint8_t  value_t;
+     static value_t  seed(void) { return _EEVALUES_CRC_SEED; }
+
+     static value_t  update( value_t crc, uint8_t data ) { return ::Crc8( crc, data ); }
+     static value_t  block( value_t crc, const uint8_t * data, unsigned len )
+                        {
+                            for( ; len > 0 ; --len )
+                                crc = ::Crc8( crc, *data++ );
+                            return crc;
+                        }
+};
+#endif
+
+
+template<> struct EeCrcEngine< EEVALUES_CRC8_NIBBLE >
+{
+     typedef uint8_t  value_t;
+     static value_t  seed(void) { return _EEVALUES_CRC_SEED; }
+
+     static const uint8_t  s_table[16] PROGMEM;
+
+     static value_t  update( value_t crc, uint8_t data )
+                        {
+                            crc ^= data;
+                            crc = (crc >> 4) ^ pgm_read_byte( & s_table[crc & 0x0F] );
+                            crc = (crc >> 4) ^ pgm_read_byte( & s_table[crc & 0x0F] );
+                            return crc;
+                        }
+     static value_t  block( value_t crc, const uint8_t * data, unsigned len )
+                        {
+                            for( ; len > 0 ; --len )
+                                crc = update( crc, *data++ );
+                            return crc;
+                        }
+};
+
+
+template<> struct EeCrcEngine< EEVALUES_CRC8_TABLE >
+{
+     typedef uint8_t  value_t;
+     static value_t  seed(void) { return _EEVALUES_CRC_SEED; }
+
+     static const uint8_t  s_table[256] PROGMEM;
+
+     static value_t  update( value_t crc, uint8_t data )
+                        { return pgm_read_byte( & s_table[crc ^ data] ); }
+     static value_t  block( value_t crc, const uint8_t * data, unsigned len )
+                        {
+                            for( ; len > 0 ; --len )
+                                crc = update( crc, *data++ );
+                            return crc;
+                        }
+};
+
+
+template<> struct EeCrcEngine< EEVALUES_CRC16_CCITT >
+{
+     typedef uint16_t  value_t;
+     static value_t  seed(void) { return 0xFFFF; }
+
+     static value_t  update( value_t crc, uint8_t data )
+                        {
+#if defined(__AVR__)
+                            return _crc_ccitt_update( crc, data );
+#else
+                            //  C equivalent given in avr-libc's <util/crc16.h>.
+                            data ^= (uint8_t) crc;
+                            data ^= (uint8_t) (data << 4);
+                            return ( ((uint16_t) data << 8) | (uint8_t) (crc >> 8) )
+                                     ^ (uint8_t) (data >> 4) ^ ((uint16_t) data << 3);
+#endif
+                        }
+     static value_t  block( value_t crc, const uint8_t * data, unsigned len )
+                        {
+                            for( ; len > 0 ; --len )
+                                crc = update( crc, *data++ );
+                            return crc;
+                        }
+};
+
+
+typedef EeCrcEngine< EEVALUES_CONF_CRC >  EeCrc;
+typedef EeCrc::value_t                    eecrc_t;
+
+
+#endif
@@ -0,0 +1,141 @@
+/** EeDescriptor.cpp ** Record descriptors kept in PROGMEM **  Oct 2026 **/
+
+#include <EeDescriptor.h>
+#include <EeSuperblock.h>
+
+#include <string.h>
+
+/* ------------------------------------------------------------------- */
+
+
+/* static */ void
+EeDesc::read( const EeDescriptor * desc, EeDescriptor * out )
+{
+    memcpy_P( out, desc, sizeof(*out) );
+}
+
+
+//  Header as EeValues would hold it for 'd', CRC not yet set.
+/* static */ void
+EeDesc::_header( const EeDescriptor & d, EeValues::EeHeader * hdr )
+{
+    hdr->m_crc = 0;
+#if _EEVALUES_HDR_FORMAT
+    hdr->m_format = _EEVALUES_FORMAT;
+#endif
+#if EEVALUES_CONF_SCHEMA
+    hdr->m_schema = d.m_schema;
+#endif
+    hdr->m_full_size = d.m_full_size;
+    hdr->m_ident = d.m_ident;
+}
+
+
+/***
+ *   Same single pass as EeValues::loadIfValid(): the stored header must
+ *   match ours byte for byte, bar the CRC, then the CRC runs over the
+ *   user's bytes as they land in 'user'.
+ *
+ *   @return true if header matches and CRC is good.
+ */
+/* static */ boolean
+EeDesc::load( const EeDescriptor * desc, void * user )
+{
+    EE_TRACE_OP( EE_OP_LOAD );
+
+    EeDescriptor        d;
+    EeValues::EeHeader  want;
+    EeValues::EeHeader  hdr;
+
+    read( desc, &d );
+    _header( d, &want );
+    EeStorage::readBlock( &hdr, d.m_offset, sizeof(hdr) );
+
+    if( (unsigned long) d.m_offset + d.m_full_size > EeStorage::size() ||
+        memcmp( (const uint8_t *) &hdr + sizeof(hdr.m_crc),
+                (const uint8_t *) &want + sizeof(want.m_crc),
+                sizeof(hdr) - sizeof(hdr.m_crc) ) != 0 )
+        return( false );
+
+    const unsigned  user_size = d.m_full_size - EeValues::HEADER_SIZE;
+
+    EeStorage::readBlock( user, d.m_offset + EeValues::HEADER_SIZE, user_size );
+
+    eecrc_t  crc = EeCrc::block( EeCrc::seed(),
+                                 (const uint8_t *) &hdr + sizeof(hdr.m_crc),
+                                 sizeof(hdr) - sizeof(hdr.m_crc) );
+    crc = EeCrc::block( crc, (const uint8_t *) user, user_size );
+
+    EE_TRACE_EVENT( EE_EV_LOAD, d.m_offset, user_size, crc == hdr.m_crc );
+    return( crc == hdr.m_crc );
+}   /* end EeDesc::load() */
+
+
+/* static */ boolean
+EeDesc::isValid( const EeDescriptor * desc )
+{
+    EeDescriptor  d;
+    read( desc, &d );
+
+    return( EeStorage::readDword( d.m_offset + offsetof(EeValues::EeHeader, m_ident) ) == d.m_ident &&
+            EeValues::_stored_size( d.m_offset ) == d.m_full_size &&
+#if EEVALUES_CONF_SCHEMA
+            EeStorage::readByte( d.m_offset + offsetof(EeValues::EeHeader, m_schema) ) == d.m_schema &&
+#endif
+            EeValues::_is_crc_valid( d.m_offset, d.m_full_size ) );
+}   /* end EeDesc::isValid() */
+
+
+/***
+ *   writeChangedToEe() without an EeValues: the header lives on the
+ *   stack just for this call.  User data goes first and the header last,
+ *   so a save cut short fails its CRC rather than passing with old data.
+ *
+ *   @return count of bytes actually written.
+ */
+/* static */ int
+EeDesc::save( const EeDescriptor * desc, const void * user, unsigned * skipped )
+{
+    EE_TRACE_OP( EE_OP_WRITE );
+
+    EeDescriptor        d;
+    EeValues::EeHeader  hdr;
+
+    read( desc, &d );
+    _header( d, &hdr );
+
+    const unsigned  user_size = d.m_full_size - EeValues::HEADER_SIZE;
+
+    eecrc_t  crc = EeCrc::block( EeCrc::seed(),
+                                 (const uint8_t *) &hdr + sizeof(hdr.m_crc),
+                                 sizeof(hdr) - sizeof(hdr.m_crc) );
+    hdr.m_crc = EeCrc::block( crc, (const uint8_t *) user, user_size );
+
+    unsigned  same = 0;
+    unsigned  written;
+
+    written  = EeValues::_write_changed( d.m_offset + EeValues::HEADER_SIZE, (const uint8_t *) user, user_size, &same );
+    written += EeValues::_write_changed( d.m_offset, (const uint8_t *) &hdr, sizeof(hdr), &same );
+
+    EE_TRACE_EVENT( EE_EV_WRITE, d.m_offset, written, same );
+#if EEVALUES_CONF_SUPERBLOCK
+    EeSuperblock::update( d.m_ident, d.m_offset, d.m_full_size );
+#endif
+
+    if( skipped )
+        *skipped = same;
+
+    return( written );
+}   /* end EeDesc::save() */
+
+
+/* static */ int
+EeDesc::invalidate( const EeDescriptor * desc )
+{
+    EeDescriptor  d;
+    read( desc, &d );
+
+    EeValues  rec( d.m_ident );
+    rec.setEeOffset( d.m_offset );
+    return( rec.invalidate() );
+}   /* end EeDesc::invalidate() */
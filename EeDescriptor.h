@@ -0,0 +1,91 @@
+/** EeDescriptor.h ** Record descriptors kept in PROGMEM **  Oct 2026 **/
+/*
+ *  An EeValues object keeps its header copy, EE offset and user-data
+ *  pointer in RAM for the life of the sketch: 10 bytes per record on an
+ *  AVR, 11 with a format byte.  Yet for a record at a fixed offset, the
+ *  ident, offset and size never change.  An EeDescriptor holds exactly
+ *  those, as constant data in flash, and the EeDesc functions build the
+ *  header on the stack only while a load or save runs:
+ *
+ *      struct MyIdent { byte poll_addr; char SN[8]; } flim;
+ *      EE_DESCRIPTOR( D_IDENT, MK4CODE('I','D','N','T'), 10, MyIdent );
+ *
+ *      if( ! EeDesc::load( &D_IDENT, &flim ) ) { ...set defaults... }
+ *      EeDesc::save( &D_IDENT, &flim );
+ *
+ *  Stored records are the same as those of EeValues, so both can read
+ *  each other's.  Descriptors have no hunt mode: the offset is the one
+ *  given, which may come from EeLayout.  With the default CRC a dozen
+ *  records free 120 bytes of SRAM and take 84 bytes of flash as
+ *  descriptors ; eebench's 'descriptor' lines give other builds.
+ */
+
+#ifndef _LIBRARIES_EEDESCRIPTOR_H
+#define _LIBRARIES_EEDESCRIPTOR_H
+
+#include "EeValues.h"
+
+
+struct EeDescriptor
+{
+     EeIdent       m_ident;
+     eeoffset_t    m_offset;           // EE offset of record's header.
+     eesize_t      m_full_size;        // including EeValues overhead.
+#if EEVALUES_CONF_SCHEMA
+     uint8_t       m_schema;           // left 0 by EE_DESCRIPTOR()
+#endif
+};
+
+//  Braced initialiser of a descriptor for '_user_size' bytes of user data,
+//  for tables of them.  '_schema' is dropped without EEVALUES_CONF_SCHEMA.
+#if EEVALUES_CONF_SCHEMA
+#define EE_DESCRIPTOR_INIT( _ident, _offset, _user_size, _schema )                      \
+    { (EeIdent) (_ident), (eeoffset_t) (_offset),                                        \
+      (eesize_t) ((_user_size) + EeValues::HEADER_SIZE), (uint8_t) (_schema) }
+#else
+#define EE_DESCRIPTOR_INIT( _ident, _offset, _user_size, _schema )                      \
+    { (EeIdent) (_ident), (eeoffset_t) (_offset),                                        \
+      (eesize_t) ((_user_size) + EeValues::HEADER_SIZE) }
+#endif
+
+//  Constant descriptor '_name' in PROGMEM, for a record of type '_type'.
+#define EE_DESCRIPTOR( _name, _ident, _offset, _type )                                  \
+    static_assert( sizeof(_type) + EeValues::HEADER_SIZE <= EEVALUES_MAX_FULL_SIZE,      \
+                   "EeDescriptor: " #_type " too big for header size field" );           \
+    constexpr EeDescriptor  _name PROGMEM = EE_DESCRIPTOR_INIT( _ident, _offset, sizeof(_type), 0 )
+
+#if EEVALUES_CONF_SCHEMA
+//  Same, for user data stored with schema version '_schema'.
+#define EE_DESCRIPTOR_SCHEMA( _name, _ident, _offset, _type, _schema )                  \
+    static_assert( sizeof(_type) + EeValues::HEADER_SIZE <= EEVALUES_MAX_FULL_SIZE,      \
+                   "EeDescriptor: " #_type " too big for header size field" );           \
+    constexpr EeDescriptor  _name PROGMEM = EE_DESCRIPTOR_INIT( _ident, _offset, sizeof(_type), _schema )
+#endif
+
+//  Every 'desc' below points into PROGMEM.
+class EeDesc
+{
+   public :
+     //  Check and copy into 'user' in one EEMEM pass, as loadIfValid().
+     //  'user' may be partly overwritten even when it returns false.
+     static boolean   load( const EeDescriptor * desc, void * user );
+
+     //  Stored record has our ident, size and a good CRC?
+     static boolean   isValid( const EeDescriptor * desc );
+
+     //  CRC from 'user', then write bytes that differ: user data first,
+     //  header last.  Returns bytes written ; 'skipped' as writeChangedToEe().
+     static int       save( const EeDescriptor * desc, const void * user, unsigned * skipped = NULL );
+
+     //  Flip one byte of the stored ident, as EeValues::invalidate().
+     static int       invalidate( const EeDescriptor * desc );
+
+     //  Descriptor copied out of PROGMEM.
+     static void      read( const EeDescriptor * desc, EeDescriptor * out );
+
+   protected :
+     static void      _header( const EeDescriptor & d, EeValues::EeHeader * hdr );
+};
+
+
+#endif
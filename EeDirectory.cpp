@@ -0,0 +1,90 @@
+/** EeDirectory.cpp ** RAM directory of all records in EEMEM **  Oct 2026 **/
+
+#include <EeDirectory.h>
+
+/* ------------------------------------------------------------------- */
+
+
+EeDirectory::EeDirectory( EeDirEntry * table, uint8_t capacity )
+{
+    m_table = table;
+    m_capacity = capacity;
+    m_count = 0;
+    m_overflow = false;
+}
+
+
+/***
+ *   Single pass over EE-memory.  At each offset the size byte is read
+ *   first, then the ident ; only a plausible header costs a CRC check.
+ *   An ident of all 0xFF or all 0x00 is blank EEMEM and skipped, which
+ *   keeps an erased part from costing a full CRC at every offset.  After
+ *   a valid record the walk jumps over it, so its contents are never
+ *   mistaken for another header.
+ *
+ *   @return number of records in the table.
+ */
+uint8_t
+EeDirectory::scan( eeoffset_t from )
+{
+    typedef EeValues::EeHeader  EeHeader;
+
+    const unsigned long  ee_size = EeStorage::size();
+    unsigned long        off = from;
+
+    EE_TRACE_OP( EE_OP_FIND );
+    EE_TRACE_EVENT( EE_EV_SCAN_BEGIN, from, 0, 0 );
+
+    m_count = 0;
+    m_overflow = false;
+
+    while( off + sizeof(EeHeader) <= ee_size )
+    {
+        const eesize_t  full_size = EeValues::_stored_size( (eeoffset_t) off );
+
+        if( full_size < sizeof(EeHeader) || off + full_size > ee_size )
+        {
+            ++off;
+            continue;
+        }
+
+        const EeIdent  id = EeStorage::readDword( off + offsetof(EeHeader, m_ident) );
+
+        if( id == 0xFFFFFFFFUL || id == 0 ||
+            ! EeValues::_is_crc_valid( off, full_size ) )
+        {
+            ++off;
+            continue;
+        }
+
+        if( m_count < m_capacity )
+        {
+            m_table[m_count].m_ident = id;
+            m_table[m_count].m_offset = off;
+            m_table[m_count].m_full_size = full_size;
+            ++m_count;
+        }
+        else
+        {
+            m_overflow = true;
+        }
+
+        off += full_size;
+    }
+
+    EE_TRACE_EVENT( EE_EV_SCAN_END, from, m_count, m_overflow );
+    return( m_count );
+}   /* end EeDirectory::scan() */
+
+
+const EeDirEntry *
+EeDirectory::lookup( EeIdent id ) const
+{
+    for( uint8_t  i = 0 ; i < m_count ; ++i )
+    {
+        if( m_table[i].m_ident == id )
+            return( & m_table[i] );
+    }
+
+    return( NULL );
+}   /* end EeDirectory::lookup() */
@@ -0,0 +1,58 @@
+/** EeDirectory.h ** RAM directory of all records in EEMEM **  Oct 2026 **/
+/*
+ *  Hunting with EeValues::findHeader() scans EE-memory once per record,
+ *  so boot time grows with both EEMEM size and record count.  Instead,
+ *  EeDirectory::scan() walks EEMEM a single time, checks each candidate
+ *  header's CRC once, and fills a caller-supplied table with every valid
+ *  record found.  Afterwards EeValues::findHeader(dir) is a table lookup.
+ *
+ *  The table lives where the caller puts it, usually on the stack during
+ *  setup(), and costs 7 bytes per entry on AVR.
+ */
+
+#ifndef _LIBRARIES_EEDIRECTORY_H
+#define _LIBRARIES_EEDIRECTORY_H
+
+#include "EeValues.h"
+
+
+struct EeDirEntry
+{
+     EeIdent       m_ident;
+     eeoffset_t    m_offset;           // EE offset of record's header.
+     eesize_t      m_full_size;        // including EeValues overhead.
+};
+
+
+class EeDirectory
+{
+   public :
+     EeDirectory( EeDirEntry * table, uint8_t capacity );
+
+     //  Walk EEMEM from 'from' to the end, recording every valid record.
+     //  Returns number of records found.
+     uint8_t   scan( eeoffset_t from = 0 );
+
+     //  Return entry for 'id', or NULL if scan() didn't find one.
+     const EeDirEntry *  lookup( EeIdent id ) const;
+
+     uint8_t   count(void) const { return m_count; }
+     const EeDirEntry &  entry( uint8_t index ) const { return m_table[index]; }
+
+     //  True if scan() found more records than the table could hold.
+     boolean   overflowed(void) const { return m_overflow; }
+
+   protected :
+     EeDirEntry *   m_table;
+     uint8_t        m_capacity;
+     uint8_t        m_count;
+     boolean        m_overflow;
+
+   private :
+     // no implementation for these:
+     EeDirectory( const EeDirectory & );
+     EeDirectory& operator=( const EeDirectory & );
+};
+
+
+#endif
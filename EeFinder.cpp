@@ -0,0 +1,202 @@
+/** EeFinder.cpp ** Resumable, budgeted findHeader() **  Oct 2026 **/
+
+#include <EeFinder.h>
+#include <EeSuperblock.h>
+
+#include <string.h>
+
+#if EEVALUES_CONF_HUNT_FOR_RECORD
+
+/* ------------------------------------------------------------------- */
+
+//  Bytes of ident offsets tried per window read.
+#define FINDER_WINDOW   16
+
+
+EeFinder::EeFinder(void)
+{
+    m_rec = NULL;
+    m_pos = 0;
+    m_end = 0;
+    m_read = 0;
+    m_base = 0;
+    m_off = 0;
+    m_left = 0;
+    m_crc = 0;
+    m_want = 0;
+    m_stored = 0;
+    m_stored_size = false;
+    m_started = false;
+    m_status = NOT_FOUND;
+}
+
+
+void
+EeFinder::begin( EeValues & rec, boolean stored_size )
+{
+    typedef EeValues::EeHeader  EeHeader;
+
+    const unsigned long  ee_size = EeStorage::size();
+
+    m_rec = &rec;
+    m_pos = (unsigned long) rec.eeOffsetOfHeader() + offsetof(EeHeader, m_ident);
+    m_end = ee_size < sizeof(EeHeader) ? 0 : ee_size - sizeof(EeHeader) + offsetof(EeHeader, m_ident) + 1;
+    m_read = 0;
+    m_left = 0;
+    m_stored_size = stored_size;
+    m_started = false;
+    m_status = IN_PROGRESS;
+
+    EE_TRACE_EVENT( EE_EV_SCAN_BEGIN, rec.eeOffsetOfHeader(), 0, rec.ident() );
+}   /* end EeFinder::begin() */
+
+
+/***
+ *   Same hunt as EeValues::_find_ident(), cut into pieces.  Each pass of
+ *   the loop either feeds the next piece of a candidate's CRC, or reads
+ *   one window of ident offsets and stops at the first match, reading
+ *   that candidate's header.  The loop ends once 'budget' is used up.
+ *
+ *   @return IN_PROGRESS until the record is found or EEMEM runs out.
+ */
+EeFinder::Status
+EeFinder::step( unsigned budget )
+{
+    typedef EeValues::EeHeader  EeHeader;
+
+    if( m_status != IN_PROGRESS )
+        return( status() );
+
+    EE_TRACE_OP( EE_OP_FIND );
+
+#if EEVALUES_CONF_SUPERBLOCK
+    if( ! m_started )
+    {
+        m_started = true;
+
+        //  Superblock says where ; still check the record is really there.
+        EeSuperblock::Entry  ent;
+
+        if( EeSuperblock::lookup( m_rec->ident(), &ent ) &&
+            EeStorage::readDword( ent.m_offset + offsetof(EeHeader, m_ident) ) == m_rec->ident() &&
+            EeValues::_is_crc_valid( ent.m_offset, m_stored_size ? ent.m_full_size : m_rec->totalSize() ) )
+        {
+            m_rec->m_header.m_full_size = ent.m_full_size;
+            m_rec->m_start_offset = ent.m_offset;
+            m_status = FOUND;
+            EE_TRACE_EVENT( EE_EV_SCAN_END, ent.m_offset, 1, 0 );
+            return( FOUND );
+        }
+    }
+#endif
+
+    uint8_t   buff[FINDER_WINDOW + sizeof(EeIdent) - 1];
+    unsigned  used = 0;
+
+    while( m_status == IN_PROGRESS && used < budget )
+    {
+        if( m_left > 0 )
+        {
+            //  Next piece of the candidate's CRC.
+            unsigned  n = m_left < sizeof(buff) ? m_left : sizeof(buff);
+            if( n > budget - used )
+                n = budget - used;
+
+            EeStorage::readBlock( buff, m_off, n );
+            m_crc = EeCrc::block( m_crc, buff, n );
+            m_off += n;
+            m_left -= n;
+            used += n;
+
+            if( m_left == 0 )
+            {
+                EE_TRACE_EVENT( EE_EV_CRC, m_base, m_off - m_base, m_crc == m_want );
+                if( m_crc == m_want )
+                    _found( m_base, m_stored );
+            }
+            continue;
+        }
+
+        if( m_pos >= m_end )
+        {
+            m_rec->m_start_offset = 0;
+            m_status = NOT_FOUND;
+            EE_TRACE_EVENT( EE_EV_SCAN_END, 0, 0, 0 );
+            break;
+        }
+
+        const unsigned  n = m_end - m_pos < FINDER_WINDOW ? (unsigned) (m_end - m_pos) : FINDER_WINDOW;
+        const uint8_t * want = (const uint8_t *) &m_rec->m_header.m_ident;
+
+        EeStorage::readBlock( buff, (eeoffset_t) m_pos, n + sizeof(EeIdent) - 1 );
+        used += n + sizeof(EeIdent) - 1;
+
+        unsigned  i = 0;
+        while( i < n && memcmp( buff + i, want, sizeof(EeIdent) ) != 0 )
+            ++i;
+
+        m_pos += i;
+        if( i == n )
+            continue;
+
+        //  Ident matches ; resume the window scan after it either way.
+        const eeoffset_t  base = (eeoffset_t) (m_pos - offsetof(EeHeader, m_ident));
+        ++m_pos;
+        used += sizeof(EeHeader);
+
+        EE_TRACE_EVENT( EE_EV_IDENT_MATCH, base, 0, 0 );
+        _candidate( base );
+    }
+
+    m_read += used;
+    return( status() );
+}   /* end EeFinder::step() */
+
+
+/***
+ *   Read the header at 'base' and, if it could be ours, set up the CRC
+ *   over the rest of the record for later steps.  The header's own bytes
+ *   go into the CRC at once.
+ */
+void
+EeFinder::_candidate( eeoffset_t base )
+{
+    typedef EeValues::EeHeader  EeHeader;
+
+    EeHeader  hdr;
+    EeStorage::readBlock( &hdr, base, sizeof(hdr) );
+
+    const unsigned  full_size = m_stored_size ? hdr.m_full_size : m_rec->totalSize();
+
+    if( full_size < sizeof(EeHeader) ||
+        (unsigned long) base + full_size > EeStorage::size() )
+        return;
+#if _EEVALUES_HDR_FORMAT
+    if( hdr.m_format != _EEVALUES_FORMAT )
+        return;
+#endif
+
+    m_base = base;
+    m_stored = hdr.m_full_size;
+    m_want = hdr.m_crc;
+    m_crc = EeCrc::block( EeCrc::seed(),
+                          (const uint8_t *) &hdr + sizeof(hdr.m_crc),
+                          sizeof(hdr) - sizeof(hdr.m_crc) );
+    m_off = base + sizeof(EeHeader);
+    m_left = full_size - sizeof(EeHeader);
+
+    if( m_left == 0 && m_crc == m_want )
+        _found( base, m_stored );
+}   /* end EeFinder::_candidate() */
+
+
+void
+EeFinder::_found( eeoffset_t base, eesize_t full_size )
+{
+    m_rec->m_header.m_full_size = full_size;
+    m_rec->m_start_offset = base;
+    m_status = FOUND;
+    EE_TRACE_EVENT( EE_EV_SCAN_END, base, 1, 0 );
+}
+
+#endif  /* EEVALUES_CONF_HUNT_FOR_RECORD */
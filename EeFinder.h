@@ -0,0 +1,81 @@
+/** EeFinder.h ** Resumable, budgeted findHeader() **  Oct 2026 **/
+/*
+ *  EeValues::findHeader() runs to the end in one call.  On a 4 KB part
+ *  with several stale copies of the ident, each one costs a CRC over the
+ *  whole record, and the call can take long enough to trip a watchdog or
+ *  miss a serial handshake.  EeFinder does the same hunt in slices:
+ *  begin() sets it up, and each step() reads at most about 'budget'
+ *  bytes of EEMEM, then returns.  A CRC over a candidate is itself split
+ *  across steps, so no single step grows with record size.
+ *
+ *      EeFinder  finder;
+ *      finder.begin( rec );
+ *      ...
+ *      //  in loop():
+ *      switch( finder.step( 64 ) ) { case EeFinder::FOUND : ... }
+ *
+ *  A step may overshoot 'budget' by one window plus one header, about
+ *  30 bytes, so it always makes progress.  With EEVALUES_CONF_SUPERBLOCK
+ *  the first step also tries the superblock ; that costs a read of its
+ *  entries and one record CRC check, a bound known at compile time.
+ *  Like findHeader(), it never writes EEMEM: see EeSuperblock::repair().
+ *
+ *  Kept apart from EeValues, like EeAsyncWriter, so records don't carry
+ *  the scan state in RAM when they never need it.
+ */
+
+#ifndef _LIBRARIES_EEFINDER_H
+#define _LIBRARIES_EEFINDER_H
+
+#include "EeValues.h"
+
+#if EEVALUES_CONF_HUNT_FOR_RECORD
+
+class EeFinder
+{
+   public :
+     enum Status { IN_PROGRESS = 0, FOUND, NOT_FOUND };
+
+     EeFinder(void);
+
+     //  Start hunting for ident of 'rec', from rec.eeOffsetOfHeader().
+     //  'stored_size' as for records whose stored size varies ( EeCompressed ).
+     void     begin( EeValues & rec, boolean stored_size = false );
+
+     //  Read at most about 'budget' bytes of EEMEM.  On FOUND, 'rec' has
+     //  offset and size set, as after a successful findHeader().
+     Status   step( unsigned budget );
+
+     Status   status(void) const { return (Status) m_status; }
+
+     //  EEMEM bytes read since begin().
+     unsigned long  bytesRead(void) const { return m_read; }
+
+   protected :
+     EeValues *     m_rec;
+     unsigned long  m_pos;              // next ident offset to try
+     unsigned long  m_end;              // one past last ident offset
+     unsigned long  m_read;
+     eeoffset_t     m_base;             // candidate's header, while m_left > 0
+     eeoffset_t     m_off;              // next candidate byte to CRC
+     unsigned       m_left;             // candidate bytes still to CRC
+     eecrc_t        m_crc;              // running CRC
+     eecrc_t        m_want;             // CRC stored in candidate's header
+     eesize_t       m_stored;           // size stored in candidate's header
+     boolean        m_stored_size;
+     boolean        m_started;
+     uint8_t        m_status;
+
+     void      _candidate( eeoffset_t base );
+     void      _found( eeoffset_t base, eesize_t full_size );
+
+   private :
+     // no implementation for these:
+     EeFinder( const EeFinder & );
+     EeFinder& operator=( const EeFinder & );
+};
+
+#endif  /* EEVALUES_CONF_HUNT_FOR_RECORD */
+
+
+#endif
@@ -0,0 +1,377 @@
+/** EeKv.cpp ** Append-only key-value log in EEMEM **  Oct 2026 **/
+
+#include <EeKv.h>
+
+#include <string.h>
+
+/* ------------------------------------------------------------------- */
+
+
+EeKv::EeKv( eeoffset_t base, unsigned long size, EeDirEntry * index, uint8_t capacity )
+{
+    m_base = base;
+    m_bank_size = size / 2;
+    m_index = index;
+    m_capacity = capacity;
+    m_count = 0;
+    m_bank = 0;
+    m_generation = 0;
+    m_tail = base + BANK_SIZE;
+}
+
+
+/***
+ *   Pick the bank with a valid bank record and the newer generation, and
+ *   replay its log into the index.  With no valid bank at all, bank 0 is
+ *   erased and formatted as generation 0.
+ *
+ *   @return false if there are more live keys than index entries.
+ */
+boolean
+EeKv::begin(void)
+{
+    EE_TRACE_OP( EE_OP_FIND );
+
+    uint32_t  gen0;
+    uint32_t  gen1;
+    const boolean  ok0 = _bank_generation( 0, &gen0 );
+    const boolean  ok1 = _bank_generation( 1, &gen1 );
+
+    if( ! ok0 && ! ok1 )
+    {
+        EeValues::eraseEe( _bank_start( 0 ), m_bank_size );
+        _write_bank( 0, 0 );
+        return( _mount( 0 ) );
+    }
+
+    //  Serial number compare, so a wrapped generation still counts as newer.
+    if( ok0 && ( ! ok1 || (int32_t) (gen0 - gen1) > 0 ) )
+        return( _mount( 0 ) );
+
+    return( _mount( 1 ) );
+}   /* end EeKv::begin() */
+
+
+int
+EeKv::get( EeIdent key, void * dst, unsigned max )
+{
+    EE_TRACE_OP( EE_OP_LOAD );
+
+    const EeDirEntry *  ent = _find( key );
+
+    if( ent == NULL )
+        return( -1 );
+
+    const unsigned  len = ent->m_full_size - EeValues::HEADER_SIZE;
+
+    EeStorage::readBlock( dst, ent->m_offset + EeValues::HEADER_SIZE, len < max ? len : max );
+    return( len );
+}   /* end EeKv::get() */
+
+
+boolean
+EeKv::put( EeIdent key, const void * src, unsigned len )
+{
+    if( key == (EeIdent) BANK_IDENT || key == 0 || key == 0xFFFFFFFFUL || len == 0 )
+        return( false );
+
+    EE_TRACE_OP( EE_OP_WRITE );
+
+    const EeDirEntry *  ent = _find( key );
+
+    if( ent != NULL && _same( *ent, src, len ) )
+        return( true );
+    if( ent == NULL && m_count >= m_capacity )
+        return( false );
+
+    return( _append( key, src, len ) );
+}   /* end EeKv::put() */
+
+
+boolean
+EeKv::remove( EeIdent key )
+{
+    if( _find( key ) == NULL )
+        return( false );
+
+    EE_TRACE_OP( EE_OP_ERASE );
+    return( _append( key, NULL, 0 ) );
+}   /* end EeKv::remove() */
+
+
+/***
+ *   Copy each live entry to the other bank as it is stored -- its CRC
+ *   doesn't depend on where it sits -- retire the old entry found at the
+ *   new tail, then write that bank's record with the next generation.
+ *   Until that last write lands, begin() still picks the old bank.  The
+ *   bank is not erased first: bytes that already match are skipped, and
+ *   stale entries past the tail are retired one by one as appends reach
+ *   them, so a compaction writes little more than the live data.
+ */
+void
+EeKv::compact(void)
+{
+    EE_TRACE_OP( EE_OP_WRITE );
+
+    const uint8_t     to = 1 - m_bank;
+    const eeoffset_t  start = _bank_start( to );
+    unsigned long     off = start + BANK_SIZE;
+    uint8_t           chunk[16];
+    unsigned          skipped = 0;
+
+    for( uint8_t  i = 0 ; i < m_count ; ++i )
+    {
+        eeoffset_t  from = m_index[i].m_offset;
+        unsigned    left = m_index[i].m_full_size;
+
+        m_index[i].m_offset = (eeoffset_t) off;
+
+        while( left > 0 )
+        {
+            const unsigned  n = left < sizeof(chunk) ? left : sizeof(chunk);
+
+            EeStorage::readBlock( chunk, from, n );
+            EeValues::_write_changed( (eeoffset_t) off, chunk, n, &skipped );
+            from += n;
+            off += n;
+            left -= n;
+        }
+    }
+
+    m_bank = to;
+    _retire( off );
+    _write_bank( to, m_generation + 1 );
+
+    m_generation += 1;
+    m_tail = off;
+}   /* end EeKv::compact() */
+
+
+/* ------------------------------------------------------------------- */
+
+/***
+ *   Fill in 'hdr' for an entry of 'key' holding 'len' bytes at 'src',
+ *   CRC included, exactly as EeValues::updateCrc8() would.
+ */
+/* static */ void
+EeKv::_seal( EeValues::EeHeader * hdr, EeIdent key, const void * src, unsigned len )
+{
+    hdr->m_crc = 0;
+#if _EEVALUES_HDR_FORMAT
+    hdr->m_format = _EEVALUES_FORMAT;
+#endif
+#if EEVALUES_CONF_SCHEMA
+    hdr->m_schema = 0;
+#endif
+    hdr->m_full_size = (eesize_t) (EeValues::HEADER_SIZE + len);
+    hdr->m_ident = key;
+
+    eecrc_t  crc = EeCrc::block( EeCrc::seed(),
+                                 (const uint8_t *) hdr + sizeof(hdr->m_crc),
+                                 sizeof(*hdr) - sizeof(hdr->m_crc) );
+
+    hdr->m_crc = EeCrc::block( crc, (const uint8_t *) src, len );
+}
+
+
+boolean
+EeKv::_bank_generation( uint8_t bank, uint32_t * generation ) const
+{
+    const eeoffset_t  off = _bank_start( bank );
+
+    if( EeStorage::readDword( off + offsetof(EeValues::EeHeader, m_ident) ) != (EeIdent) BANK_IDENT ||
+        EeValues::_stored_size( off ) != BANK_SIZE ||
+        ! EeValues::_is_crc_valid( off, BANK_SIZE ) )
+        return( false );
+
+    EeStorage::readBlock( generation, off + EeValues::HEADER_SIZE, sizeof(*generation) );
+    return( true );
+}
+
+
+//  Generation first, header last, so a torn write leaves no bank record.
+void
+EeKv::_write_bank( uint8_t bank, uint32_t generation )
+{
+    EeValues::EeHeader  hdr;
+    _seal( &hdr, BANK_IDENT, &generation, sizeof(generation) );
+
+    unsigned  skipped = 0;
+    EeValues::_write_changed( _bank_start( bank ) + EeValues::HEADER_SIZE, (const uint8_t *) &generation, sizeof(generation), &skipped );
+    EeValues::_write_changed( _bank_start( bank ), (const uint8_t *) &hdr, sizeof(hdr), &skipped );
+}
+
+
+/***
+ *   Replay the log of 'bank' into the index.  Later entries override
+ *   earlier ones and tombstones drop their key.  The log ends at blank
+ *   EEMEM or at the first entry that fails its check, i.e. a torn append.
+ */
+boolean
+EeKv::_mount( uint8_t bank )
+{
+    const unsigned long  end = _bank_start( bank ) + m_bank_size;
+    unsigned long        off = _bank_start( bank ) + BANK_SIZE;
+    boolean              ok = true;
+
+    m_bank = bank;
+    m_count = 0;
+    _bank_generation( bank, &m_generation );
+
+    while( off + EeValues::HEADER_SIZE <= end )
+    {
+        const EeIdent   key = EeStorage::readDword( (eeoffset_t) off + offsetof(EeValues::EeHeader, m_ident) );
+        const eesize_t  full_size = EeValues::_stored_size( (eeoffset_t) off );
+
+        if( key == 0xFFFFFFFFUL || full_size < EeValues::HEADER_SIZE || off + full_size > end ||
+            ! EeValues::_is_crc_valid( (eeoffset_t) off, full_size ) )
+            break;
+
+        EeDirEntry *  ent = _find( key );
+
+        if( full_size == EeValues::HEADER_SIZE )
+        {
+            if( ent != NULL )
+                *ent = m_index[--m_count];
+        }
+        else if( ent != NULL || m_count < m_capacity )
+        {
+            if( ent == NULL )
+                ent = & m_index[m_count++];
+
+            ent->m_ident = key;
+            ent->m_offset = (eeoffset_t) off;
+            ent->m_full_size = full_size;
+        }
+        else
+        {
+            ok = false;
+        }
+
+        off += full_size;
+    }
+
+    m_tail = off;
+    EE_TRACE_EVENT( EE_EV_SCAN_END, _bank_start( bank ), m_count, m_generation );
+    return( ok );
+}   /* end EeKv::_mount() */
+
+
+EeDirEntry *
+EeKv::_find( EeIdent key )
+{
+    for( uint8_t  i = 0 ; i < m_count ; ++i )
+    {
+        if( m_index[i].m_ident == key )
+            return( & m_index[i] );
+    }
+
+    return( NULL );
+}
+
+
+/***
+ *   Compacts first if the bank is full.  Whatever old entry sits where
+ *   this one will end is retired before anything is written, so replay
+ *   can never run on into it.  Value first, header last, and only bytes
+ *   that differ are written ; a torn append fails its CRC.
+ */
+boolean
+EeKv::_append( EeIdent key, const void * src, unsigned len )
+{
+    const unsigned long  full_size = (unsigned long) EeValues::HEADER_SIZE + len;
+
+    if( full_size > EEVALUES_MAX_FULL_SIZE || full_size + BANK_SIZE > m_bank_size )
+        return( false );
+
+    if( full_size > available() )
+    {
+        compact();
+        if( full_size > available() )
+            return( false );
+    }
+
+    EeValues::EeHeader  hdr;
+    _seal( &hdr, key, src, len );
+
+    _retire( m_tail + full_size );
+
+    unsigned  skipped = 0;
+    EeValues::_write_changed( (eeoffset_t) m_tail + EeValues::HEADER_SIZE, (const uint8_t *) src, len, &skipped );
+    EeValues::_write_changed( (eeoffset_t) m_tail, (const uint8_t *) &hdr, sizeof(hdr), &skipped );
+    EE_TRACE_EVENT( EE_EV_WRITE, (eeoffset_t) m_tail, (unsigned) full_size, 0 );
+
+    EeDirEntry *  ent = _find( key );
+
+    if( len == 0 )
+    {
+        if( ent != NULL )
+            *ent = m_index[--m_count];
+    }
+    else
+    {
+        if( ent == NULL )
+            ent = & m_index[m_count++];
+
+        ent->m_ident = key;
+        ent->m_offset = (eeoffset_t) m_tail;
+        ent->m_full_size = (eesize_t) full_size;
+    }
+
+    m_tail += full_size;
+    return( true );
+}   /* end EeKv::_append() */
+
+
+/***
+ *   Replay stops at the first entry that fails its check, so the offset
+ *   just past the log must never hold one that passes.  If an old entry
+ *   from an earlier generation of this bank starts at 'off', flip a byte
+ *   of its ident.
+ */
+void
+EeKv::_retire( unsigned long off )
+{
+    const unsigned long  end = _bank_start( m_bank ) + m_bank_size;
+
+    if( off + EeValues::HEADER_SIZE > end )
+        return;
+
+    const eeoffset_t  at = (eeoffset_t) off + offsetof(EeValues::EeHeader, m_ident);
+    const uint8_t     have = EeStorage::readByte( at );
+    const eesize_t    full_size = EeValues::_stored_size( (eeoffset_t) off );
+
+    if( full_size < EeValues::HEADER_SIZE || off + full_size > end ||
+        ! EeValues::_is_crc_valid( (eeoffset_t) off, full_size ) )
+        return;
+
+    EeStorage::writeByte( at, (uint8_t) ~have );
+}
+
+
+//  Stored value of 'ent' is already 'len' bytes at 'src'?
+boolean
+EeKv::_same( const EeDirEntry & ent, const void * src, unsigned len ) const
+{
+    if( ent.m_full_size != EeValues::HEADER_SIZE + len )
+        return( false );
+
+    const uint8_t *  p = (const uint8_t *) src;
+    eeoffset_t       off = ent.m_offset + EeValues::HEADER_SIZE;
+    uint8_t          chunk[16];
+
+    while( len > 0 )
+    {
+        const unsigned  n = len < sizeof(chunk) ? len : sizeof(chunk);
+
+        EeStorage::readBlock( chunk, off, n );
+        if( memcmp( chunk, p, n ) != 0 )
+            return( false );
+
+        p += n;
+        off += n;
+        len -= n;
+    }
+
+    return( true );
+}
@@ -0,0 +1,107 @@
+/** EeKv.h ** Append-only key-value log in EEMEM **  Oct 2026 **/
+/*
+ *  Many small settings each need an EeValues object and a hand-placed
+ *  offset, and each is rewritten in place, so the bytes of a busy one
+ *  wear out first.  EeKv keeps them all in one region of EEMEM as a log:
+ *  put() appends a new entry instead of rewriting, and a RAM index,
+ *  built once by begin(), maps each key to its latest entry.
+ *
+ *  Each entry is an ordinary EeValues record: header with CRC, size and
+ *  ident, where the ident is the key, then the value.  A value of length
+ *  0 is a tombstone left by remove().  The region is split in two banks.
+ *  The active bank starts with an "EeKB" record holding a generation
+ *  number.  When the log fills, compact() copies the live entries to the
+ *  other bank and writes its bank record last, with the next generation.
+ *  Power lost at any point leaves one whole bank with the newest
+ *  generation, and begin() picks that one.  A torn append fails its CRC
+ *  and ends the log there ; the next put() writes over it.  Banks are
+ *  never erased: only bytes that differ are written, and an old entry
+ *  where the log will end is retired by a one byte tombstone first.
+ *
+ *      EeDirEntry  index[ 16 ];
+ *      EeKv        kv( 64, 512, index, 16 );
+ *      kv.begin();
+ *      kv.put( MK4CODE('B','A','U','D'), &baud, sizeof(baud) );
+ *      kv.get( MK4CODE('B','A','U','D'), &baud, sizeof(baud) );
+ *
+ *  Keys share the ident space of plain EeValues records, so don't reuse
+ *  a record's ident as a key if findHeader() hunts over the region.  The
+ *  index costs 7 bytes per key on AVR ; begin() fails if there are more
+ *  live keys than it holds.
+ */
+
+#ifndef _LIBRARIES_EEKV_H
+#define _LIBRARIES_EEKV_H
+
+#include "EeValues.h"
+#include "EeDirectory.h"        // EeDirEntry
+
+
+class EeKv
+{
+   public :
+     enum { BANK_IDENT = MK4CODE('E','e','K','B'),
+            BANK_SIZE  = EeValues::HEADER_SIZE + sizeof(uint32_t) };
+
+     //  Log lives in 'size' bytes of EEMEM from 'base' ; the index of
+     //  'capacity' entries is the caller's RAM.
+     EeKv( eeoffset_t base, unsigned long size, EeDirEntry * index, uint8_t capacity );
+
+     //  Find the active bank and build the index ; formats an empty log
+     //  if neither bank is valid.  False if the index overflowed.
+     boolean   begin(void);
+
+     //  Copy value of 'key' into 'dst', at most 'max' bytes.
+     //  Returns the value's length, or -1 if there is no such key.
+     int       get( EeIdent key, void * dst, unsigned max );
+
+     //  Append 'len' bytes as the new value of 'key'.  An unchanged value
+     //  writes nothing.  Compacts when the bank is full.  False if the
+     //  value can't fit even then, or the index is full.
+     boolean   put( EeIdent key, const void * src, unsigned len );
+
+     //  Append a tombstone for 'key'.  False if nothing to remove.
+     boolean   remove( EeIdent key );
+
+     //  Copy live entries to the other bank and switch to it.
+     void      compact(void);
+
+     //  Live keys, and their entries.
+     uint8_t   count(void) const { return m_count; }
+     const EeDirEntry &  entry( uint8_t index ) const { return m_index[index]; }
+
+     //  Bytes of the active bank used and left for appends.
+     unsigned long  used(void) const { return m_tail - _bank_start( m_bank ); }
+     unsigned long  available(void) const { return _bank_start( m_bank ) + m_bank_size - m_tail; }
+
+     //  Bumped by every compact().
+     uint32_t  generation(void) const { return m_generation; }
+
+   protected :
+     eeoffset_t     m_base;
+     unsigned long  m_bank_size;
+     EeDirEntry *   m_index;
+     uint8_t        m_capacity;
+     uint8_t        m_count;
+     uint8_t        m_bank;             // 0 or 1
+     uint32_t       m_generation;
+     unsigned long  m_tail;             // EE offset of next append
+
+     eeoffset_t     _bank_start( uint8_t bank ) const { return m_base + bank * m_bank_size; }
+     static void    _seal( EeValues::EeHeader * hdr, EeIdent key, const void * src, unsigned len );
+     boolean        _bank_generation( uint8_t bank, uint32_t * generation ) const;
+     void           _write_bank( uint8_t bank, uint32_t generation );
+     boolean        _mount( uint8_t bank );
+     void           _retire( unsigned long off );
+     EeDirEntry *   _find( EeIdent key );
+     boolean        _append( EeIdent key, const void * src, unsigned len );
+     boolean        _same( const EeDirEntry & ent, const void * src, unsigned len ) const;
+
+   private :
+     // no implementation for these:
+     EeKv( const EeKv & );
+     EeKv& operator=( const EeKv & );
+};
+
+
+#endif
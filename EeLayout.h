@@ -0,0 +1,116 @@
+/** EeLayout.h ** Compile-time EEMEM layout of several records **  Oct 2026 **/
+/*
+ *  Instead of hand-picking non-overlapping offsets, or hunting for each
+ *  record at boot, list the user record types once and let the compiler
+ *  place them end-to-end:
+ *
+ *      typedef EeLayout< MyIdent, MyConfig, MyCounters >  Layout;
+ *
+ *      EeValues  ident( REC_IDENT );
+ *      ident.setEeOffset( Layout::offsetOf< MyIdent >() );     // or offset<0>()
+ *
+ *  Offsets are constexpr, so they cost no RAM and no search ; a layout
+ *  that overflows EEVALUES_EE_SIZE fails to compile.  EeLayoutAt< BASE,
+ *  PAGE, ... > starts at BASE and puts each record on a PAGE boundary,
+ *  for parts where a write must not straddle a page.  With
+ *  EEVALUES_CONF_SUPERBLOCK, EeLayout starts at EeSuperblock::END and a
+ *  layout over the superblock fails to compile.  Needs C++11.
+ */
+
+#ifndef _LIBRARIES_EELAYOUT_H
+#define _LIBRARIES_EELAYOUT_H
+
+#include "EeValues.h"
+#include "EeSuperblock.h"
+
+//  First EE offset EeLayout places a record at.
+#if EEVALUES_CONF_SUPERBLOCK
+#define EEVALUES_LAYOUT_BASE    ((unsigned) EeSuperblock::END)
+#else
+#define EEVALUES_LAYOUT_BASE    0
+#endif
+
+/* ------------------------------------------------------------------- */
+
+//  One placed record: type 'T' at 'offset', then the rest of the list.
+template< unsigned OFF, unsigned PAGE, class... Ts >
+struct _EeLayoutNode
+{
+     static constexpr unsigned  end = OFF;
+};
+
+template< unsigned OFF, unsigned PAGE, class T, class... Rest >
+struct _EeLayoutNode< OFF, PAGE, T, Rest... >
+{
+     static_assert( sizeof(T) + EeValues::HEADER_SIZE <= EEVALUES_MAX_FULL_SIZE, "EeLayout: record too big for header size field" );
+
+     static constexpr unsigned  offset = (OFF + PAGE - 1) / PAGE * PAGE;
+     static constexpr unsigned  size = EeValues::HEADER_SIZE + sizeof(T);
+
+     typedef _EeLayoutNode< offset + size, PAGE, Rest... >  next;
+
+     static constexpr unsigned  end = next::end;
+};
+
+
+//  Offset of the I'th record.
+template< unsigned I, class N >
+struct _EeLayoutIndex
+{
+     static constexpr unsigned  value = _EeLayoutIndex< I - 1, typename N::next >::value;
+};
+
+template< class N >
+struct _EeLayoutIndex< 0, N >
+{
+     static constexpr unsigned  value = N::offset;
+};
+
+
+//  Offset of the first record of type T ; no match is a compile error.
+template< class T, class N >
+struct _EeLayoutFind
+{
+     static constexpr unsigned  value = _EeLayoutFind< T, typename N::next >::value;
+};
+
+template< class T, unsigned OFF, unsigned PAGE, class... Rest >
+struct _EeLayoutFind< T, _EeLayoutNode< OFF, PAGE, T, Rest... > >
+{
+     static constexpr unsigned  value = _EeLayoutNode< OFF, PAGE, T, Rest... >::offset;
+};
+
+
+/* ------------------------------------------------------------------- */
+
+template< unsigned BASE, unsigned PAGE, class... Ts >
+struct EeLayoutAt
+{
+     static_assert( PAGE > 0, "EeLayout: page size must be at least 1" );
+
+     typedef _EeLayoutNode< BASE, PAGE, Ts... >  first;
+
+     //  EE offset of the I'th record's header.
+     template< unsigned I >
+     static constexpr eeoffset_t  offset() { return _EeLayoutIndex< I, first >::value; }
+
+     //  EE offset of the header of the record of type T.
+     template< class T >
+     static constexpr eeoffset_t  offsetOf() { return _EeLayoutFind< T, first >::value; }
+
+     //  First EE offset past the last record.
+     static constexpr unsigned  end = first::end;
+
+     static_assert( end <= EEVALUES_EE_SIZE, "EeLayout: records don't fit in EEMEM" );
+#if EEVALUES_CONF_SUPERBLOCK
+     static_assert( BASE >= (unsigned) EeSuperblock::END || end <= (unsigned) EeSuperblock::OFFSET,
+                    "EeLayout: records overlap the superblock" );
+#endif
+};
+
+
+template< class... Ts >
+using EeLayout = EeLayoutAt< EEVALUES_LAYOUT_BASE, 1, Ts... >;
+
+
+#endif
@@ -0,0 +1,311 @@
+/** EePagedStorage.h ** External paged EEPROM / FRAM back-end **  Oct 2026 **/
+/*
+ *  Serial EEPROMs such as the 24LCxx ( I2C ) and 25LCxx ( SPI ) latch a
+ *  whole page, 16 to 128 bytes, and program it in one write cycle of
+ *  about 5 ms.  Writing them a byte at a time costs one cycle per byte.
+ *  EePagedStorage< BUS > splits every block write and fill into bursts
+ *  that never cross a page boundary, one write cycle each, and waits for
+ *  the part by polling it ( ACK polling on I2C, the WIP status bit on
+ *  SPI ) instead of a fixed delay.  It only polls after a write, until
+ *  the part first answers ready, so reads of an idle part cost no bus
+ *  traffic beyond the read.  Reads are sequential, so a CRC scan or
+ *  readToUser() is one address phase per burst, not per byte.
+ *
+ *  A BUS is a struct of statics:
+ *      enum { PAGE, BURST } ; SIZE      page, most bytes per transaction, device size
+ *      read( addr, dst, n )             sequential read
+ *      beginWrite( addr ) ; writeData( b ) ; endWrite()
+ *                                       one burst ; endWrite() starts the write cycle
+ *      isReady()                        true if no write cycle in progress
+ *
+ *  Provided: EeI2cBus ( 24LC32 and up, 2 byte addresses ), EeSpiBus
+ *  ( 25LCxx, and SPI FRAM given PAGE == SIZE ), and on a host build
+ *  EeSimPagedBus, a device model with page wrap and write-cycle time.
+ *  Parts over 64 KB need EEVALUES_CONF_LARGE ; EeSpiBus then sends 3
+ *  address bytes, and EeI2cBus puts address bits 16 and up in the low
+ *  bits of the device address ( 24LC1026, 24CM02 ; the 24LC1025 uses
+ *  bit 2 instead and needs its own bus ).
+ *
+ *  Select with, in EeStorage.h or on the compiler line:
+ *      #define EEVALUES_CONF_BACKEND    EEVALUES_BACKEND_PAGED
+ *      #define EEVALUES_CONF_PAGED_BUS  EeI2cBus< 0x50, 64, 32768UL >
+ *  The sketch must call Wire.begin(), or SPI.begin() and set CS_PIN as
+ *  an OUTPUT, before touching a record.
+ */
+
+#ifndef _LIBRARIES_EEPAGEDSTORAGE_H
+#define _LIBRARIES_EEPAGEDSTORAGE_H
+
+#if defined(ARDUINO)
+#include <Wire.h>
+#include <SPI.h>
+#else
+#include <string.h>
+#endif
+
+
+/* ------------------------------------------------------------------- */
+
+template< class BUS >
+struct EePagedStorage
+{
+     enum { SIZE = BUS::SIZE };
+
+     static_assert( sizeof(eeoffset_t) > 2 || BUS::SIZE <= 65536UL, "EePagedStorage: part over 64 KB needs EEVALUES_CONF_LARGE" );
+
+     static uint8_t   readByte( eeoffset_t off )
+                        { uint8_t v; readBlock( &v, off, sizeof(v) ); return v; }
+     static uint32_t  readDword( eeoffset_t off )
+                        { uint32_t v; readBlock( &v, off, sizeof(v) ); return v; }
+     static void      readBlock( void * dst, eeoffset_t off, size_t n )
+                        {
+                            _wait_ready();
+                            BUS::read( off, (uint8_t *) dst, n );
+                        }
+
+     static void      writeByte( eeoffset_t off, uint8_t value )
+                        { _write( off, &value, 0, 1 ); }
+     static void      writeBlock( eeoffset_t off, const void * src, size_t n )
+                        { _write( off, (const uint8_t *) src, 0, n ); }
+     static void      fill( eeoffset_t off, uint8_t value, size_t n )
+                        { _write( off, NULL, value, n ); }
+
+     static boolean   isReady(void)
+                        {
+                            if( s_write_pending && BUS::isReady() )
+                                s_write_pending = false;
+                            return( ! s_write_pending );
+                        }
+
+     static unsigned long  size(void) { return BUS::SIZE; }
+
+     //  Bursts of at most one page, and never across a page boundary.
+     //  Waits only before a burst, so the last write cycle runs on
+     //  while the caller carries on.  'src' NULL means fill with 'value'.
+     static void      _write( eeoffset_t off, const uint8_t * src, uint8_t value, size_t n )
+                        {
+                            while( n > 0 )
+                            {
+                                size_t  chunk = BUS::PAGE - (off % BUS::PAGE);
+                                if( chunk > (size_t) BUS::BURST )
+                                    chunk = BUS::BURST;
+                                if( chunk > n )
+                                    chunk = n;
+
+                                _wait_ready();
+                                BUS::beginWrite( off );
+                                for( size_t  i = 0 ; i < chunk ; ++i )
+                                    BUS::writeData( src ? *src++ : value );
+                                BUS::endWrite();
+                                s_write_pending = true;
+
+                                off += chunk;
+                                n -= chunk;
+                            }
+                        }
+
+     static void      _wait_ready(void)
+                        {
+                            while( ! isReady() )
+                                ;
+                        }
+
+     static boolean   s_write_pending;      // write cycle may be running.
+};
+
+template< class BUS > boolean  EePagedStorage< BUS >::s_write_pending = false;
+
+
+/* ------------------------------------------------------------------- */
+
+#if defined(ARDUINO)
+
+//  Wire's buffer holds the 2 address bytes too.
+#ifndef EEVALUES_I2C_BURST_MAX
+#define EEVALUES_I2C_BURST_MAX      (BUFFER_LENGTH - 2)
+#endif
+
+template< uint8_t ADDR, unsigned PAGE_, unsigned long SIZE_ >
+struct EeI2cBus
+{
+     enum { PAGE = PAGE_,
+            BURST = PAGE_ < EEVALUES_I2C_BURST_MAX ? PAGE_ : EEVALUES_I2C_BURST_MAX };
+     static const unsigned long  SIZE = SIZE_;
+
+     static void      read( eeoffset_t addr, uint8_t * dst, size_t n )
+                        {
+                            while( n > 0 )
+                            {
+                                uint8_t  chunk = n < BUFFER_LENGTH ? n : BUFFER_LENGTH;
+
+                                //  Sequential read stays inside one 64 KB block.
+                                if( SIZE > 65536UL && 0x10000UL - (addr & 0xFFFF) < chunk )
+                                    chunk = 0x10000UL - (addr & 0xFFFF);
+
+                                _address( addr );
+                                Wire.endTransmission( false );      // repeated start
+                                Wire.requestFrom( _device( addr ), chunk );
+                                for( uint8_t  i = 0 ; i < chunk ; ++i )
+                                    *dst++ = Wire.read();
+
+                                addr += chunk;
+                                n -= chunk;
+                            }
+                        }
+
+     static void      beginWrite( eeoffset_t addr ) { _address( addr ); }
+     static void      writeData( uint8_t b ) { Wire.write( b ); }
+     static void      endWrite(void) { Wire.endTransmission(); }
+
+     //  ACK polling: part ignores its address while in a write cycle.
+     static boolean   isReady(void)
+                        {
+                            Wire.beginTransmission( ADDR );
+                            return( Wire.endTransmission() == 0 );
+                        }
+
+     //  Block select bits of parts over 64 KB ride in the device address.
+     static uint8_t   _device( eeoffset_t addr )
+                        { return( SIZE > 65536UL ? (uint8_t) (ADDR | (uint8_t) ((unsigned long) addr >> 16)) : ADDR ); }
+
+     static void      _address( eeoffset_t addr )
+                        {
+                            Wire.beginTransmission( _device( addr ) );
+                            Wire.write( (uint8_t) (addr >> 8) );
+                            Wire.write( (uint8_t) addr );
+                        }
+};
+
+
+template< uint8_t CS_PIN, unsigned PAGE_, unsigned long SIZE_ >
+struct EeSpiBus
+{
+     enum { PAGE = PAGE_, BURST = PAGE_ };
+     static const unsigned long  SIZE = SIZE_;
+
+     enum { OP_WREN = 0x06, OP_RDSR = 0x05, OP_READ = 0x03, OP_WRITE = 0x02, SR_WIP = 0x01 };
+
+     static void      read( eeoffset_t addr, uint8_t * dst, size_t n )
+                        {
+                            _command( OP_READ, addr );
+                            for( ; n > 0 ; --n )
+                                *dst++ = SPI.transfer( 0 );
+                            digitalWrite( CS_PIN, HIGH );
+                        }
+
+     static void      beginWrite( eeoffset_t addr )
+                        {
+                            digitalWrite( CS_PIN, LOW );
+                            SPI.transfer( OP_WREN );
+                            digitalWrite( CS_PIN, HIGH );
+                            _command( OP_WRITE, addr );
+                        }
+     static void      writeData( uint8_t b ) { SPI.transfer( b ); }
+     static void      endWrite(void) { digitalWrite( CS_PIN, HIGH ); }
+
+     //  FRAM has no write cycle ; its WIP bit always reads 0.
+     static boolean   isReady(void)
+                        {
+                            digitalWrite( CS_PIN, LOW );
+                            SPI.transfer( OP_RDSR );
+                            const uint8_t  sr = SPI.transfer( 0 );
+                            digitalWrite( CS_PIN, HIGH );
+                            return( (sr & SR_WIP) == 0 );
+                        }
+
+     static void      _command( uint8_t op, eeoffset_t addr )
+                        {
+                            digitalWrite( CS_PIN, LOW );
+                            SPI.transfer( op );
+                            if( SIZE > 65536UL )
+                                SPI.transfer( (uint8_t) ((unsigned long) addr >> 16) );
+                            SPI.transfer( (uint8_t) (addr >> 8) );
+                            SPI.transfer( (uint8_t) addr );
+                        }
+};
+
+#else   /* host */
+
+/***
+ *   Host model of a paged serial EEPROM.  Like the real part, data bytes
+ *   of one burst past the end of the page wrap to its start, and a read
+ *   past the end of the device wraps to address 0.  The write cycle is
+ *   modelled, not slept: each burst adds CYCLE_US of busy time, and on a
+ *   modelled clock the part stays busy for that long after endWrite().
+ *   Each isReady() poll while busy takes POLL_US of that clock, as an
+ *   ACK poll or status read on the bus would ; elapse() lets other work
+ *   pass time, so a write cycle can run on behind it.
+ */
+template< unsigned PAGE_, unsigned long SIZE_, unsigned CYCLE_US = 5000, unsigned POLL_US = 100 >
+struct EeSimPagedBus
+{
+     enum { PAGE = PAGE_, BURST = PAGE_, CYCLE = CYCLE_US, POLL = POLL_US };
+     static const unsigned long  SIZE = SIZE_;
+
+     static void      read( eeoffset_t addr, uint8_t * dst, size_t n )
+                        {
+                            ++s_transactions;
+                            s_bytes_read += n;
+                            for( ; n > 0 ; --n, addr = (addr + 1) % SIZE_ )
+                                *dst++ = s_mem[addr];
+                        }
+
+     static void      beginWrite( eeoffset_t addr ) { ++s_transactions; s_addr = addr; }
+     static void      writeData( uint8_t b )
+                        {
+                            s_mem[s_addr] = b;
+                            ++s_bytes_written;
+                            s_addr = (s_addr / PAGE_) * PAGE_ + (s_addr + 1) % PAGE_;
+                        }
+     static void      endWrite(void)
+                        {
+                            ++s_cycles;
+                            s_busy_us += CYCLE_US;
+                            s_ready_us = s_now_us + CYCLE_US;
+                        }
+
+     static boolean   isReady(void)
+                        {
+                            ++s_polls;
+                            if( s_now_us >= s_ready_us )
+                                return true;
+                            ++s_busy_polls;
+                            s_now_us += POLL_US;
+                            return false;
+                        }
+
+     static void      elapse( unsigned long us ) { s_now_us += us; }
+
+     //  Blank and idle the part, and zero the counters.
+     static void      erase(void) { memset( s_mem, 0xFF, sizeof(s_mem) ); s_ready_us = s_now_us; reset(); }
+     static void      reset(void) { s_transactions = s_cycles = s_busy_us = s_polls = s_busy_polls = s_bytes_read = s_bytes_written = 0; }
+
+     static uint8_t        s_mem[ SIZE_ ];
+     static eeoffset_t     s_addr;
+     static unsigned long  s_transactions;
+     static unsigned long  s_cycles;            // write cycles, one per burst.
+     static unsigned long  s_busy_us;
+     static unsigned long  s_polls;             // isReady() calls.
+     static unsigned long  s_busy_polls;        // isReady() calls that found it busy.
+     static unsigned long  s_bytes_read;
+     static unsigned long  s_bytes_written;
+     static unsigned long  s_now_us;            // modelled clock
+     static unsigned long  s_ready_us;          // end of the current write cycle
+};
+
+template< unsigned P, unsigned long S, unsigned C, unsigned Q > uint8_t        EeSimPagedBus< P, S, C, Q >::s_mem[ S ];
+template< unsigned P, unsigned long S, unsigned C, unsigned Q > eeoffset_t     EeSimPagedBus< P, S, C, Q >::s_addr;
+template< unsigned P, unsigned long S, unsigned C, unsigned Q > unsigned long  EeSimPagedBus< P, S, C, Q >::s_transactions;
+template< unsigned P, unsigned long S, unsigned C, unsigned Q > unsigned long  EeSimPagedBus< P, S, C, Q >::s_cycles;
+template< unsigned P, unsigned long S, unsigned C, unsigned Q > unsigned long  EeSimPagedBus< P, S, C, Q >::s_busy_us;
+template< unsigned P, unsigned long S, unsigned C, unsigned Q > unsigned long  EeSimPagedBus< P, S, C, Q >::s_bytes_read;
+template< unsigned P, unsigned long S, unsigned C, unsigned Q > unsigned long  EeSimPagedBus< P, S, C, Q >::s_bytes_written;
+template< unsigned P, unsigned long S, unsigned C, unsigned Q > unsigned long  EeSimPagedBus< P, S, C, Q >::s_polls;
+template< unsigned P, unsigned long S, unsigned C, unsigned Q > unsigned long  EeSimPagedBus< P, S, C, Q >::s_busy_polls;
+template< unsigned P, unsigned long S, unsigned C, unsigned Q > unsigned long  EeSimPagedBus< P, S, C, Q >::s_now_us;
+template< unsigned P, unsigned long S, unsigned C, unsigned Q > unsigned long  EeSimPagedBus< P, S, C, Q >::s_ready_us;
+
+#endif  /* ARDUINO */
+
+
+#endif
@@ -0,0 +1,167 @@
+/** EeRecord.h ** Typed EEMEM record with field-level dirty tracking **  Oct 2026 **/
+/*
+ *  EeRecord<T, ID> owns a 'T' in RAM and binds it to an EeValues header,
+ *  replacing the hand wiring of setUserDataPtr() / setUserSize().  Fields
+ *  are changed through set(), which marks only the bytes that actually
+ *  changed in a one-bit-per-byte bitmap.  commit() then recomputes the
+ *  CRC from RAM and writes just those bytes plus the CRC, without reading
+ *  EEMEM back.  For a config block where one counter changes often and
+ *  the rest almost never, a commit is a handful of bytes.
+ *
+ *      struct MyIdent { byte poll_addr; char SN[8]; };
+ *      EeRecord< MyIdent, MK4CODE('I','D','N','T') >  ident( 10 );
+ *
+ *      if( ! ident.load() ) { ...set defaults... }
+ *      ident.set( &MyIdent::poll_addr, (byte) 0x42 );
+ *      ident.commit();
+ *
+ *  Until load() succeeds, EEMEM can't be trusted to match RAM, so the
+ *  first commit() falls back to writeChangedToEe() over the whole record.
+ *  The same goes after any EeValues call that moves the record or writes
+ *  EEMEM itself -- setEeOffset(), findHeader(), invalidate(), the erases,
+ *  writeToEe() -- so a commit never lands only its dirty bytes on a
+ *  record that isn't there.
+ */
+
+#ifndef _LIBRARIES_EERECORD_H
+#define _LIBRARIES_EERECORD_H
+
+#include "EeValues.h"
+
+
+template< class T, EeIdent ID >
+class EeRecord : public EeValues
+{
+   public :
+     EeRecord( eeoffset_t offset ) : EeValues( ID )
+        {
+            static_assert( sizeof(T) + sizeof(EeHeader) <= EEVALUES_MAX_FULL_SIZE, "EeRecord: T too big for header size field" );
+
+            memset( &m_data, 0, sizeof(m_data) );
+            memset( m_dirty, 0, sizeof(m_dirty) );
+            m_synced = false;
+
+            setUserDataPtr( &m_data );
+            setUserSize( sizeof(T) );
+            setEeOffset( offset );
+        }
+
+     //  Read-only view ; change fields through set().
+     const T &  get(void) const { return m_data; }
+
+     //  Validate and load from EEMEM in one pass.  After success, EEMEM is
+     //  known to equal RAM and commits become dirty-bytes-only.
+     boolean    load(void) { return( loadIfValid() ); }
+
+     boolean    loadIfValid(void)
+        {
+            m_synced = EeValues::loadIfValid();
+            memset( m_dirty, 0, sizeof(m_dirty) );
+            return( m_synced );
+        }
+
+     //  EeValues entry points that move the record, or change EEMEM
+     //  behind RAM's back.  EEMEM can no longer be trusted to match, so
+     //  the next commit() writes the whole record again.
+     void       setEeOffset( eeoffset_t offset ) { m_synced = false; EeValues::setEeOffset( offset ); }
+#if EEVALUES_CONF_HUNT_FOR_RECORD
+     boolean    findHeader(void) { m_synced = false; return( EeValues::findHeader() ); }
+     boolean    findHeader( const EeDirectory & dir ) { m_synced = false; return( EeValues::findHeader( dir ) ); }
+#endif
+     int        invalidate(void) { m_synced = false; return( EeValues::invalidate() ); }
+     void       eraseWholeRecord( uint8_t fill_value = 0xff ) { m_synced = false; EeValues::eraseWholeRecord( fill_value ); }
+     void       eraseEeUserData( uint8_t fill_value = 0xff ) { m_synced = false; EeValues::eraseEeUserData( fill_value ); }
+     void       eraseEeHeader(void) { m_synced = false; EeValues::eraseEeHeader(); }
+     int        writeToEe(void) { m_synced = false; return( EeValues::writeToEe() ); }
+     int        writeChangedToEe( unsigned * skipped = NULL ) { m_synced = false; return( EeValues::writeChangedToEe( skipped ) ); }
+     boolean    loadIfValid( EeChunkSink sink, void * context, uint8_t * scratch, unsigned scratch_size )
+        {
+            m_synced = false;
+            return( EeValues::loadIfValid( sink, context, scratch, scratch_size ) );
+        }
+
+     //  Set one field, e.g. set( &T::poll_addr, v ).  Marks changed bytes.
+     template< class F >
+     void       set( F T::* field, const F & value )
+        {
+            setBytes( (const uint8_t *) &(m_data.*field) - (const uint8_t *) &m_data, &value, sizeof(F) );
+        }
+
+     //  Set 'len' raw bytes at 'offset' within T ; only differing bytes are marked.
+     void       setBytes( unsigned offset, const void * src, unsigned len )
+        {
+            uint8_t *        dst = (uint8_t *) &m_data + offset;
+            const uint8_t *  s = (const uint8_t *) src;
+
+            for( ; len > 0 ; --len, ++offset, ++dst, ++s )
+            {
+                if( *dst != *s )
+                {
+                    *dst = *s;
+                    m_dirty[offset >> 3] |= (uint8_t) (1 << (offset & 7));
+                }
+            }
+        }
+
+     boolean    isDirty(void) const
+        {
+            for( unsigned  i = 0 ; i < sizeof(m_dirty) ; ++i )
+                if( m_dirty[i] )
+                    return( true );
+            return( false );
+        }
+
+     //  Write dirty bytes and CRC.  Returns count of bytes written.
+     int        commit(void)
+        {
+            EE_TRACE_OP( EE_OP_WRITE );
+
+            updateCrc8();
+
+            int  written;
+
+            if( ! m_synced )
+            {
+                written = EeValues::writeChangedToEe();
+                m_synced = true;
+            }
+            else
+            {
+                if( ! isDirty() )
+                    return( 0 );
+
+                written = 0;
+                for( unsigned  i = 0 ; i < sizeof(T) ; ++i )
+                {
+                    if( m_dirty[i >> 3] & (1 << (i & 7)) )
+                    {
+                        EeStorage::writeByte( eeOffsetOfUserRecord() + i, ((const uint8_t *) &m_data)[i] );
+                        ++written;
+                    }
+                }
+
+                //  CRC last, so record validates only once data is in.
+                const eecrc_t  crc = crc8();
+                EeStorage::writeBlock( eeOffsetOfHeader() + offsetof(EeHeader, m_crc), &crc, sizeof(crc) );
+                written += sizeof(crc);
+                EE_TRACE_EVENT( EE_EV_WRITE, eeOffsetOfHeader(), written, 0 );
+                _note_written();
+            }
+
+            memset( m_dirty, 0, sizeof(m_dirty) );
+            return( written );
+        }
+
+   protected :
+     T              m_data;
+     uint8_t        m_dirty[ (sizeof(T) + 7) / 8 ];
+     boolean        m_synced;          // EEMEM known to equal RAM as of last load/commit.
+
+   private :
+     //  RAM side is fixed to 'm_data'.
+     using EeValues::setUserDataPtr;
+     using EeValues::setUserSize;
+};
+
+
+#endif
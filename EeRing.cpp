@@ -0,0 +1,213 @@
+/** EeRing.cpp ** Wear-levelled ring of EEMEM slots for one record **  Oct 2026 **/
+
+#include <EeRing.h>
+
+/* ------------------------------------------------------------------- */
+
+
+EeRing::EeRing( EeIdent id, eeoffset_t base, uint8_t slots )
+    : EeValues( id )
+{
+    m_base = base;
+    m_slots = slots;
+    m_slot = 0;
+    m_found = false;
+    m_sequence = 0;
+
+    m_start_offset = base;
+}
+
+
+/***
+ *   Find the newest slot with our ident and a valid CRC.  Only the ident
+ *   and sequence of each slot are read to rank them ; the CRC, which
+ *   costs a read of the whole slot, is checked newest first.  Normally
+ *   that is one header read per slot plus one CRC pass.  If the newest
+ *   is torn, the next older is tried, and so on.
+ *
+ *   With EEVALUES_CONF_SCHEMA, a slot stored with another schema than
+ *   setSchema() is skipped, as EeValues::loadIfValid() would refuse it.
+ *
+ *   Sequence numbers are compared by signed difference, so wrap from
+ *   0xFFFF to 0 still orders correctly.  Ties go to the higher slot.
+ *
+ *   @return true if any slot is valid ; header offset is then set to it.
+ */
+boolean
+EeRing::findNewest(void)
+{
+    boolean     have_limit = false;
+    EeSequence  limit_seq = 0;
+    uint8_t     limit_slot = 0;
+
+    EE_TRACE_OP( EE_OP_FIND );
+    EE_TRACE_EVENT( EE_EV_SCAN_BEGIN, m_base, 0, ident() );
+
+    m_found = false;
+
+    for( ;; )
+    {
+        boolean     have_best = false;
+        EeSequence  best_seq = 0;
+        uint8_t     best_slot = 0;
+
+        for( uint8_t  k = 0 ; k < m_slots ; ++k )
+        {
+            const eeoffset_t  off = slotOffset( k );
+
+            if( EeStorage::readDword( off + offsetof(EeHeader, m_ident) ) != ident() )
+                continue;
+#if EEVALUES_CONF_SCHEMA
+            if( EeStorage::readByte( off + offsetof(EeHeader, m_schema) ) != m_header.m_schema )
+                continue;
+#endif
+
+            EeSequence  seq;
+            EeStorage::readBlock( &seq, off + sizeof(EeHeader), sizeof(seq) );
+
+            //  Already tried everything from 'limit' up.
+            if( have_limit && ! _is_older( seq, k, limit_seq, limit_slot ) )
+                continue;
+
+            if( ! have_best || _is_older( best_seq, best_slot, seq, k ) )
+            {
+                have_best = true;
+                best_seq = seq;
+                best_slot = k;
+            }
+        }
+
+        if( ! have_best )
+            break;
+
+        if( _is_crc_valid( slotOffset( best_slot ), totalSize() ) )
+        {
+            m_found = true;
+            m_slot = best_slot;
+            m_sequence = best_seq;
+            break;
+        }
+
+        have_limit = true;
+        limit_seq = best_seq;
+        limit_slot = best_slot;
+    }
+
+    m_start_offset = slotOffset( m_found ? m_slot : 0 );
+    EE_TRACE_EVENT( EE_EV_SCAN_END, m_start_offset, m_found, m_sequence );
+    return( m_found );
+}   /* end EeRing::findNewest() */
+
+
+/* static */ boolean
+EeRing::_is_older( EeSequence a_seq, uint8_t a_slot, EeSequence b_seq, uint8_t b_slot )
+{
+    const int16_t  diff = (int16_t) (a_seq - b_seq);
+
+    return( diff < 0 || (diff == 0 && a_slot < b_slot) );
+}
+
+
+/***
+ *   Write the record to the slot after the newest one.  The newest slot
+ *   is left alone until this one is complete, so a power failure part
+ *   way through still leaves the previous copy valid.  Bytes that already
+ *   hold the right value ( e.g. from N commits ago ) are not rewritten.
+ *
+ *   @return count of bytes written.
+ */
+int
+EeRing::commit(void)
+{
+    EE_TRACE_OP( EE_OP_WRITE );
+
+    if( m_found )
+    {
+        m_slot = (uint8_t) ((m_slot + 1) % m_slots);
+        ++m_sequence;
+    }
+    else
+    {
+        m_slot = 0;
+        m_sequence = 0;
+    }
+
+    m_start_offset = slotOffset( m_slot );
+    updateCrc8();
+
+    unsigned  skipped = 0;
+    unsigned  written;
+
+    written  = _write_changed( m_start_offset, (const uint8_t *) &this->m_header, sizeof(this->m_header), &skipped );
+    written += _write_changed( _sequence_offset(), (const uint8_t *) &m_sequence, sizeof(m_sequence), &skipped );
+    written += _write_changed( _user_offset(), (const uint8_t *) userDataPtr(), userRecordSize(), &skipped );
+
+    m_found = true;
+    EE_TRACE_EVENT( EE_EV_WRITE, m_start_offset, written, skipped );
+    return( written );
+}   /* end EeRing::commit() */
+
+
+int
+EeRing::readToUser(void)
+{
+    EE_TRACE_OP( EE_OP_LOAD );
+    EeStorage::readBlock( userDataPtr(), _user_offset(), userRecordSize() );
+
+    return( userRecordSize() );
+}   /* end EeRing::readToUser() */
+
+
+/***
+ *  CRC covers header ( less CRC byte ), sequence number, then client's
+ *  portion of the record, in the order they sit in EEMEM.
+ */
+void
+EeRing::updateCrc8()
+{
+    eecrc_t   crc = EeCrc::block( EeCrc::seed(),
+                                (const uint8_t *) &this->m_header + sizeof(m_header.m_crc),
+                                sizeof(this->m_header) - sizeof(m_header.m_crc) );
+
+    crc = EeCrc::block( crc, (const uint8_t *) &m_sequence, sizeof(m_sequence) );
+    crc = EeCrc::block( crc, (const uint8_t *) userDataPtr(), userRecordSize() );
+
+    setCrc8( crc );
+}   /* end EeRing::updateCrc8() */
+
+
+/***
+ *   Tombstone every slot that holds our ident.  Only the newest would
+ *   leave the older copies for the next findNewest() to bring back.
+ *
+ *   @return count of slots tombstoned.
+ */
+int
+EeRing::invalidate(void)
+{
+    int   count = 0;
+
+    for( uint8_t  k = 0 ; k < m_slots ; ++k )
+    {
+        m_start_offset = slotOffset( k );
+        count += EeValues::invalidate();
+    }
+
+    m_found = false;
+    m_start_offset = m_base;
+    return( count );
+}   /* end EeRing::invalidate() */
+
+
+void
+EeRing::eraseWholeRecord( uint8_t fill_value )
+{
+    for( uint8_t  k = 0 ; k < m_slots ; ++k )
+    {
+        m_start_offset = slotOffset( k );
+        EeValues::eraseWholeRecord( fill_value );
+    }
+
+    m_found = false;
+    m_start_offset = m_base;
+}   /* end EeRing::eraseWholeRecord() */
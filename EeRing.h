@@ -0,0 +1,114 @@
+/** EeRing.h ** Wear-levelled ring of EEMEM slots for one record **  Oct 2026 **/
+/*
+ *  A record that changes often wears out its EEMEM bytes ( about 100k
+ *  write cycles ).  EeRing spreads commits across 'slots' copies laid
+ *  end-to-end from 'base', i.e. at "base + K * totalSize()".  Each commit
+ *  goes to the slot after the newest one, so the hot slot is never
+ *  erased-then-rewritten and each byte sees 1/N of the writes.
+ *
+ *  Every slot holds an extended header: the usual EeHeader followed by a
+ *  16-bit sequence number, all covered by the CRC.  findNewest() picks
+ *  the valid slot with the highest sequence (wrap-around safe).  If power
+ *  fails mid-commit, that slot's CRC is bad and the previous one wins.
+ *
+ *  EeShadow is the two slot case: an A/B pair where each commit goes to
+ *  the inactive copy, so the live copy is never overwritten.
+ *
+ *  Use EeRing's own setUserSize(), userRecordSize(), updateCrc8() and
+ *  readToUser() ; the EeValues versions don't know about the sequence.
+ *  The EeValues entry points that work on one fixed offset -- writeToEe(),
+ *  loadIfValid(), findHeader() and the like -- would bypass the ring, so
+ *  they are private here and calling them fails to compile.  invalidate()
+ *  and eraseWholeRecord() are EeRing's own and act on every slot.
+ */
+
+#ifndef _LIBRARIES_EERING_H
+#define _LIBRARIES_EERING_H
+
+#include "EeValues.h"
+
+typedef uint16_t  EeSequence;
+
+
+class EeRing : public EeValues
+{
+   public :
+     EeRing( EeIdent id, eeoffset_t base, uint8_t slots );
+
+     //  Look at every slot, keep the newest with a valid CRC.
+     boolean  findNewest(void);
+
+     //  Bump sequence, update CRC, write to the next slot in the ring.
+     //  Returns count of bytes written.
+     int      commit(void);
+
+     //  Copies user's portion of newest slot into setUserDataPtr().
+     int      readToUser(void);
+
+     //  False, and size left as it was, if the slot would exceed EEVALUES_MAX_FULL_SIZE.
+     boolean  setUserSize( unsigned siz )
+                { return( EeValues::setUserSize( siz + sizeof(EeSequence) ) ); }
+     unsigned userRecordSize(void) const { return m_header.m_full_size - sizeof(EeHeader) - sizeof(EeSequence); }
+
+     void     updateCrc8();
+
+     //  Retire the record in every slot, so findNewest() can't fall back
+     //  to an older copy.  invalidate() returns count of tombstones written.
+     int      invalidate(void);
+     void     eraseWholeRecord( uint8_t fill_value = 0xff );
+
+     EeSequence  sequence(void) const { return m_sequence; }
+     uint8_t     slot(void) const { return m_slot; }
+     uint8_t     slots(void) const { return m_slots; }
+
+     eeoffset_t  slotOffset( uint8_t k ) const { return m_base + (eeoffset_t) k * totalSize(); }
+
+     //  Total EEMEM used by the ring.
+     unsigned long  ringSize(void) const { return (unsigned long) m_slots * totalSize(); }
+
+   protected :
+     eeoffset_t     m_base;
+     uint8_t        m_slots;
+     uint8_t        m_slot;             // slot of newest, valid if m_found.
+     boolean        m_found;
+     EeSequence     m_sequence;
+
+     //  True if (a_seq, a_slot) was written before (b_seq, b_slot).
+     static boolean  _is_older( EeSequence a_seq, uint8_t a_slot, EeSequence b_seq, uint8_t b_slot );
+
+     eeoffset_t  _sequence_offset(void) const { return eeOffsetOfHeader() + sizeof(EeHeader); }
+     eeoffset_t  _user_offset(void) const { return _sequence_offset() + sizeof(EeSequence); }
+
+   private :
+     //  Fixed-offset entry points of EeValues: use findNewest() and commit().
+#if EEVALUES_CONF_HUNT_FOR_RECORD
+     using EeValues::findHeader;
+#endif
+     using EeValues::isHeaderValid;
+     using EeValues::write;
+     using EeValues::writeToEe;
+     using EeValues::writeChangedToEe;
+     using EeValues::loadIfValid;
+     using EeValues::setEeOffset;
+     using EeValues::eeOffsetOfUserRecord;
+     using EeValues::eraseEeHeader;
+     using EeValues::eraseEeUserData;
+};
+
+
+/* ------------------------------------------------------------------- */
+
+class EeShadow : public EeRing
+{
+   public :
+     EeShadow( EeIdent id, eeoffset_t base ) : EeRing( id, base, 2 ) {}
+
+     //  Newest valid of the A and B copies ; see EeRing::findNewest().
+     boolean  isHeaderValid(void) { return findNewest(); }
+
+     //  Slot that holds the live copy, 0 for A, 1 for B.
+     uint8_t  activeSlot(void) const { return slot(); }
+};
+
+
+#endif
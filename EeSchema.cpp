@@ -0,0 +1,424 @@
+/** EeSchema.cpp ** Migrate records stored with an older user layout **  Oct 2026 **/
+
+#include <EeSchema.h>
+
+#include <string.h>
+
+/* ------------------------------------------------------------------- */
+
+
+/* static */ int
+EeSchema::loadOrMigrate( EeValues & rec, const EeMigration * table, uint8_t count )
+{
+    return( _migrate( rec, table, count, false, 0 ) );
+}
+
+
+/* static */ int
+EeSchema::loadOrMigrate( EeValues & rec, const EeMigration * table, uint8_t count,
+                         eeoffset_t spare )
+{
+    return( _migrate( rec, table, count, true, spare ) );
+}
+
+
+/***
+ *   A copy power cut short is finished first.  Then try the current
+ *   layout: that is the boot path of every unit already upgraded, and
+ *   costs one loadIfValid().  Otherwise find the stored record by its
+ *   ident whatever its size, or header, check its CRC over the size it
+ *   was stored with, and look its layout up in 'table'.  All old fields
+ *   are read before anything is written, then the new record goes out
+ *   through the same skip-if-equal path as writeChangedToEe(), by way of
+ *   the spare if there is one.
+ *
+ *   @return 0 if current, bytes written if migrated, -1 if neither.
+ */
+/* static */ int
+EeSchema::_migrate( EeValues & rec, const EeMigration * table, uint8_t count,
+                    boolean use_spare, eeoffset_t spare )
+{
+    if( use_spare )
+    {
+        const int  resumed = _resume( rec, spare );
+        if( resumed > 0 )
+            return( resumed );
+    }
+
+    if( rec.loadIfValid() )
+        return( 0 );
+
+#if EEVALUES_CONF_SCHEMA
+    const uint8_t  now_schema = rec.schema();
+#else
+    const uint8_t  now_schema = 0;
+#endif
+
+    uint8_t   schema;
+    unsigned  header_size;
+    unsigned  full_size;
+
+    if( ! _find_old( rec, &schema, &header_size, &full_size ) )
+        return( -1 );
+
+    const eeoffset_t  base = rec.m_start_offset;
+    const unsigned    want = rec.totalSize();
+    const unsigned    old_size = full_size - header_size;
+    const boolean     legacy = header_size != EeValues::HEADER_SIZE;
+
+    //  Same layout as now, found by hunting: nothing to migrate.
+    if( ! legacy && schema == now_schema && old_size == rec.userRecordSize() )
+        return( rec.loadIfValid() ? 0 : -1 );
+
+    //  Only the header changed: a schema 0 record of the same size
+    //  carries over whole.
+    EeMigration  m;
+    boolean      whole = false;
+
+    if( ! _match( table, count, schema, old_size, &m ) )
+    {
+        if( ! legacy || now_schema != 0 || old_size != rec.userRecordSize() )
+            return( -1 );
+        whole = true;
+    }
+
+    //  Growing must not land on the next record, nor the spare.
+    const unsigned long  end = (unsigned long) base + ( want > full_size ? want : full_size );
+
+    if( (unsigned long) base + want > EeStorage::size() ||
+        ( want > full_size && ! _is_free( (unsigned long) base + full_size, end ) ) )
+        return( -1 );
+
+    if( use_spare &&
+        ( spareSize( rec ) > EEVALUES_MAX_FULL_SIZE ||
+          (unsigned long) spare + spareSize( rec ) > EeStorage::size() ||
+          ( spare < end && base < (unsigned long) spare + spareSize( rec ) ) ) )
+        return( -1 );
+
+    EE_TRACE_OP( EE_OP_WRITE );
+
+    uint8_t *  user = (uint8_t *) rec.userDataPtr();
+
+    if( whole )
+        EeStorage::readBlock( user, base + header_size, old_size );
+
+    for( uint8_t  i = 0 ; ! whole && i < m.m_count ; ++i )
+    {
+        EeFieldMap  f;
+        memcpy_P( &f, m.m_fields + i, sizeof(f) );
+
+        if( (unsigned long) f.m_from + f.m_length > old_size ||
+            (unsigned long) f.m_to + f.m_length > rec.userRecordSize() )
+            return( -1 );
+
+        EeStorage::readBlock( user + f.m_to, base + header_size + f.m_from, f.m_length );
+    }
+
+    rec.updateCrc8();
+
+    unsigned  written = 0;
+
+    if( use_spare )
+        written += _publish( rec, spare );
+
+    written += _place( rec, base );
+
+    if( use_spare )
+    {
+        EeValues  marker( ~rec.ident() );
+        marker.setEeOffset( spare );
+        written += marker.invalidate();
+    }
+
+    EE_TRACE_EVENT( EE_EV_WRITE, base, written, 0 );
+    rec._note_written();
+
+    return( written );
+}   /* end EeSchema::_migrate() */
+
+
+//  First entry of PROGMEM 'table' for the stored 'schema' and 'user_size'.
+/* static */ boolean
+EeSchema::_match( const EeMigration * table, uint8_t count,
+                  uint8_t schema, unsigned user_size, EeMigration * out )
+{
+    for( uint8_t  i = 0 ; i < count ; ++i )
+    {
+        memcpy_P( out, table + i, sizeof(*out) );
+
+#if EEVALUES_CONF_SCHEMA
+        if( out->m_schema != schema )
+            continue;
+#else
+        (void) schema;
+#endif
+        if( out->m_user_size == user_size )
+            return( true );
+    }
+
+    return( false );
+}   /* end EeSchema::_match() */
+
+/* ------------------------------------------------------------------- */
+
+/***
+ *   Stored record for 'rec' in any layout: at its offset, else hunted
+ *   for from there.  A record with today's header comes first ; with
+ *   EEVALUES_CONF_SCHEMA, one with the header of a build without it is
+ *   looked for next, as schema 0.  Sets rec's offset to the one found.
+ *
+ *   @return true, with its schema, header size and full size, if found.
+ */
+/* static */ boolean
+EeSchema::_find_old( EeValues & rec, uint8_t * schema, unsigned * header_size, unsigned * full_size )
+{
+    typedef EeValues::EeHeader  EeHeader;
+
+    const eeoffset_t  at = rec.m_start_offset;
+    const eesize_t    want = rec.m_header.m_full_size;
+    boolean           found;
+
+    found = EeStorage::readDword( at + offsetof(EeHeader, m_ident) ) == rec.ident() &&
+            EeValues::_is_crc_valid( at, EeValues::_stored_size( at ) );
+
+#if EEVALUES_CONF_HUNT_FOR_RECORD
+    if( ! found )
+    {
+        found = rec._find_ident( true );
+        rec.m_header.m_full_size = want;
+    }
+#else
+    (void) want;
+#endif
+
+    if( found )
+    {
+        EeHeader  hdr;
+        EeStorage::readBlock( &hdr, rec.m_start_offset, sizeof(hdr) );
+
+#if EEVALUES_CONF_SCHEMA
+        *schema = hdr.m_schema;
+#else
+        *schema = 0;
+#endif
+        *header_size = EeValues::HEADER_SIZE;
+        *full_size = hdr.m_full_size;
+        return( true );
+    }
+
+#if EEVALUES_CONF_SCHEMA
+    eeoffset_t  base = at;
+
+    found = _legacy_valid( base, rec.ident(), full_size );
+
+#if EEVALUES_CONF_HUNT_FOR_RECORD
+    //  Same window scan as EeValues::_find_ident(), for the older header.
+    const EeIdent        id = rec.ident();
+    const unsigned long  ee_size = EeStorage::size();
+    const unsigned long  end_ident = ee_size < sizeof(EeLegacyHeader) ? 0 :
+                            ee_size - sizeof(EeLegacyHeader) + offsetof(EeLegacyHeader, m_ident) + 1;
+    uint8_t              window[16 + sizeof(EeIdent) - 1];
+
+    for( unsigned long  pos = (unsigned long) at + offsetof(EeLegacyHeader, m_ident) ; ! found && pos < end_ident ; )
+    {
+        const unsigned  n = end_ident - pos < 16 ? (unsigned) (end_ident - pos) : 16;
+
+        EeStorage::readBlock( window, (eeoffset_t) pos, n + sizeof(EeIdent) - 1 );
+
+        for( unsigned  i = 0 ; ! found && i < n ; ++i )
+        {
+            if( memcmp( window + i, &id, sizeof(id) ) != 0 )
+                continue;
+
+            base = (eeoffset_t) (pos + i - offsetof(EeLegacyHeader, m_ident));
+            found = _legacy_valid( base, id, full_size );
+        }
+
+        pos += n;
+    }
+#endif
+
+    if( found )
+    {
+        rec.m_start_offset = base;
+        *schema = 0;
+        *header_size = sizeof(EeLegacyHeader);
+        return( true );
+    }
+#endif
+
+    return( false );
+}   /* end EeSchema::_find_old() */
+
+
+#if EEVALUES_CONF_SCHEMA
+
+//  Record 'id' at 'base' with the header of a build without schema?
+/* static */ boolean
+EeSchema::_legacy_valid( eeoffset_t base, EeIdent id, unsigned * full_size )
+{
+    EeLegacyHeader  hdr;
+
+    if( (unsigned long) base + sizeof(hdr) > EeStorage::size() )
+        return( false );
+
+    EeStorage::readBlock( &hdr, base, sizeof(hdr) );
+
+    if( hdr.m_ident != id || hdr.m_full_size < sizeof(hdr) ||
+        (unsigned long) base + hdr.m_full_size > EeStorage::size() )
+        return( false );
+
+#if _EESCHEMA_LEGACY_HDR_FORMAT
+    if( hdr.m_format != _EESCHEMA_LEGACY_FORMAT )
+        return( false );
+#endif
+
+    if( _crc( base + sizeof(hdr.m_crc), hdr.m_full_size - sizeof(hdr.m_crc), EeCrc::seed() ) != hdr.m_crc )
+        return( false );
+
+    *full_size = hdr.m_full_size;
+    return( true );
+}   /* end EeSchema::_legacy_valid() */
+
+#endif  /* EEVALUES_CONF_SCHEMA */
+
+
+//  Every byte of [from, to) reads 0xFF?
+/* static */ boolean
+EeSchema::_is_free( unsigned long from, unsigned long to )
+{
+    uint8_t  chunk[16];
+
+    while( from < to )
+    {
+        const unsigned  n = to - from < sizeof(chunk) ? (unsigned) (to - from) : sizeof(chunk);
+
+        EeStorage::readBlock( chunk, (eeoffset_t) from, n );
+        for( unsigned  i = 0 ; i < n ; ++i )
+            if( chunk[i] != 0xFF )
+                return( false );
+        from += n;
+    }
+
+    return( true );
+}
+
+
+//  CRC of 'count' EEMEM bytes from 'from', continuing 'crc'.
+/* static */ eecrc_t
+EeSchema::_crc( eeoffset_t from, unsigned count, eecrc_t crc )
+{
+    uint8_t  chunk[16];
+
+    while( count > 0 )
+    {
+        const unsigned  n = count < sizeof(chunk) ? count : sizeof(chunk);
+
+        EeStorage::readBlock( chunk, from, n );
+        crc = EeCrc::block( crc, chunk, n );
+        from += n;
+        count -= n;
+    }
+
+    return( crc );
+}
+
+
+//  Sealed 'rec' out at 'base': user data first, header last.
+/* static */ unsigned
+EeSchema::_place( EeValues & rec, eeoffset_t base )
+{
+    unsigned  same = 0;
+    unsigned  written;
+
+    rec.m_start_offset = base;
+
+    written  = EeValues::_write_changed( rec.eeOffsetOfUserRecord(), (const uint8_t *) rec.userDataPtr(),
+                                         rec.userRecordSize(), &same );
+    written += EeValues::_write_changed( base, (const uint8_t *) &rec.m_header, sizeof(rec.m_header), &same );
+
+    return( written );
+}
+
+
+/***
+ *   Sealed 'rec' out at 'spare' as a record of its own: ident inverted,
+ *   and the offset it is bound for ahead of the user data.  Header last,
+ *   so it only counts once it is whole.
+ *
+ *   @return bytes written.
+ */
+/* static */ unsigned
+EeSchema::_publish( EeValues & rec, eeoffset_t spare )
+{
+    EeValues::EeHeader  hdr = rec.m_header;
+    const eeoffset_t    target = rec.m_start_offset;
+
+    hdr.m_ident = ~rec.ident();
+    hdr.m_full_size = (eesize_t) spareSize( rec );
+
+    eecrc_t  crc = EeCrc::block( EeCrc::seed(),
+                                 (const uint8_t *) &hdr + sizeof(hdr.m_crc),
+                                 sizeof(hdr) - sizeof(hdr.m_crc) );
+    crc = EeCrc::block( crc, (const uint8_t *) &target, sizeof(target) );
+    hdr.m_crc = EeCrc::block( crc, (const uint8_t *) rec.userDataPtr(), rec.userRecordSize() );
+
+    unsigned  same = 0;
+    unsigned  written;
+
+    written  = EeValues::_write_changed( spare + EeValues::HEADER_SIZE, (const uint8_t *) &target, sizeof(target), &same );
+    written += EeValues::_write_changed( spare + EeValues::HEADER_SIZE + sizeof(target),
+                                         (const uint8_t *) rec.userDataPtr(), rec.userRecordSize(), &same );
+    written += EeValues::_write_changed( spare, (const uint8_t *) &hdr, sizeof(hdr), &same );
+
+    return( written );
+}   /* end EeSchema::_publish() */
+
+
+/***
+ *   A whole record at 'spare' for 'rec' means a migration was cut short
+ *   after it was published: load it, copy it where it was bound, and
+ *   retire the spare.  Copying skips bytes already right, so a resume
+ *   cut short just runs again.
+ *
+ *   @return bytes written, 0 if the spare holds nothing for 'rec'.
+ */
+/* static */ int
+EeSchema::_resume( EeValues & rec, eeoffset_t spare )
+{
+    typedef EeValues::EeHeader  EeHeader;
+
+    const EeIdent   id = ~rec.ident();
+    const unsigned  full_size = spareSize( rec );
+
+    if( (unsigned long) spare + full_size > EeStorage::size() ||
+        EeStorage::readDword( spare + offsetof(EeHeader, m_ident) ) != id ||
+        EeValues::_stored_size( spare ) != full_size ||
+#if EEVALUES_CONF_SCHEMA
+        EeStorage::readByte( spare + offsetof(EeHeader, m_schema) ) != rec.schema() ||
+#endif
+        ! EeValues::_is_crc_valid( spare, full_size ) )
+        return( 0 );
+
+    eeoffset_t  target;
+    EeStorage::readBlock( &target, spare + EeValues::HEADER_SIZE, sizeof(target) );
+
+    if( (unsigned long) target + rec.totalSize() > EeStorage::size() )
+        return( 0 );
+
+    EE_TRACE_OP( EE_OP_WRITE );
+
+    EeStorage::readBlock( rec.userDataPtr(), spare + EeValues::HEADER_SIZE + sizeof(target), rec.userRecordSize() );
+    rec.updateCrc8();
+
+    unsigned  written = _place( rec, target );
+
+    EeValues  marker( id );
+    marker.setEeOffset( spare );
+    written += marker.invalidate();
+
+    EE_TRACE_EVENT( EE_EV_WRITE, target, written, 0 );
+    rec._note_written();
+
+    return( written );
+}   /* end EeSchema::_resume() */
@@ -0,0 +1,123 @@
+/** EeSchema.h ** Migrate records stored with an older user layout **  Oct 2026 **/
+/*
+ *  When firmware adds or moves a field, a record stored by the old
+ *  firmware no longer matches: its size or schema differs, loadIfValid()
+ *  fails, and the sketch either falls back to defaults or rewrites the
+ *  whole record.  EeSchema::loadOrMigrate() instead recognises an older
+ *  layout from a table, carries the old values over field by field into
+ *  the user's struct, and rewrites the record in place -- writing only the
+ *  bytes that differ, so fields that didn't move cost nothing.
+ *
+ *      //  v0 was { char SN[8]; } ; v1 put 'poll_addr' in front of it.
+ *      static const EeFieldMap   v0_fields[] PROGMEM = { { 0, 1, 8 } };
+ *      static const EeMigration  migrations[] PROGMEM = { { 0, 8, v0_fields, 1 } };
+ *
+ *      ...set defaults in 'flim'...
+ *      rec.setSchema( 1 );
+ *      int  n = EeSchema::loadOrMigrate( rec, migrations, 1 );
+ *
+ *  An old layout is matched on its stored user size and, with
+ *  EEVALUES_CONF_SCHEMA, its stored schema version ; without it the size
+ *  alone tells layouts apart, so records of a fleet built without a
+ *  schema byte can still be migrated.  Turning EEVALUES_CONF_SCHEMA on
+ *  changes the header itself, so loadOrMigrate() also reads a record
+ *  stored with the header of that build ( no schema byte, the older
+ *  format byte ) as schema 0 ; one of the same user size needs no table
+ *  entry when the record is still schema 0.  Fields the old layout lacks
+ *  keep the defaults already in the user's struct.  Tables live in PROGMEM.
+ *
+ *  The new record goes where the old one was.  A record that grows --
+ *  a larger user size, or the schema byte added to its header -- is only
+ *  migrated if the bytes it grows into read 0xFF, as eraseEe() leaves
+ *  free EEMEM ; otherwise loadOrMigrate() refuses rather than overwrite
+ *  the next record.  Leave room after a record that may grow.
+ *
+ *  Rewritten in place, power lost part way leaves the record invalid and
+ *  the old values gone.  Pass a 'spare' region of spareSize() bytes to
+ *  make the migration torn-safe: the new record is first written there,
+ *  ident inverted so no findHeader() takes it, header last ; then copied
+ *  in place and the spare retired with one byte.  A later call with the
+ *  same spare finishes a copy that power cut short.
+ */
+
+#ifndef _LIBRARIES_EESCHEMA_H
+#define _LIBRARIES_EESCHEMA_H
+
+#include "EeValues.h"
+
+#if EEVALUES_CONF_SCHEMA
+//  Header as stored by the same build without EEVALUES_CONF_SCHEMA: no
+//  schema byte, and header version 2 or 3 in the format byte, if any.
+#define _EESCHEMA_LEGACY_HDR_FORMAT     (EEVALUES_CONF_CRC != EEVALUES_CRC8_LIB || EEVALUES_CONF_LARGE)
+#define _EESCHEMA_LEGACY_FORMAT         (((_EEVALUES_HDR_VERSION - 2) << 4) | EEVALUES_CONF_CRC)
+
+struct PACKED EeLegacyHeader
+{
+     eecrc_t               m_crc;
+#if _EESCHEMA_LEGACY_HDR_FORMAT
+     uint8_t               m_format;
+#endif
+     eesize_t              m_full_size;
+     EeIdent               m_ident;
+};
+#endif
+
+
+//  One run of bytes carried from the old user data to the new.
+struct EeFieldMap
+{
+     uint16_t              m_from;             // offset in old user data
+     uint16_t              m_to;               // offset in new user data
+     uint16_t              m_length;
+};
+
+//  How to bring one old layout up to date.
+struct EeMigration
+{
+     uint8_t               m_schema;           // stored schema ; ignored without EEVALUES_CONF_SCHEMA
+     eesize_t              m_user_size;        // stored user size
+     const EeFieldMap *    m_fields;           // PROGMEM
+     uint8_t               m_count;
+};
+
+
+class EeSchema
+{
+   public :
+     //  Load 'rec' if stored in the current layout, else migrate it from
+     //  the first matching entry of 'table' ( PROGMEM, 'count' entries ).
+     //  'rec' must have user data pointer, size, schema and offset set,
+     //  and its user data hold defaults for fields the old layout lacks.
+     //  Returns 0 if loaded as is, bytes written if migrated, or -1 if no
+     //  valid record in a known layout was found, or it can't grow where
+     //  it is ; user data may then hold garbage, so set the defaults again.
+     static int   loadOrMigrate( EeValues & rec, const EeMigration * table, uint8_t count );
+
+     //  As above, torn-safe: the migrated record is published at 'spare'
+     //  first.  Call with the same spare at every boot.
+     static int   loadOrMigrate( EeValues & rec, const EeMigration * table, uint8_t count,
+                                 eeoffset_t spare );
+
+     //  Bytes of EEMEM a spare for 'rec' needs.
+     static unsigned  spareSize( const EeValues & rec )
+                         { return rec.totalSize() + sizeof(eeoffset_t); }
+
+   protected :
+     static int       _migrate( EeValues & rec, const EeMigration * table, uint8_t count,
+                                boolean use_spare, eeoffset_t spare );
+     static boolean   _match( const EeMigration * table, uint8_t count,
+                              uint8_t schema, unsigned user_size, EeMigration * out );
+     static boolean   _find_old( EeValues & rec, uint8_t * schema, unsigned * header_size, unsigned * full_size );
+     static boolean   _is_free( unsigned long from, unsigned long to );
+     static unsigned  _place( EeValues & rec, eeoffset_t base );
+     static int       _resume( EeValues & rec, eeoffset_t spare );
+     static unsigned  _publish( EeValues & rec, eeoffset_t spare );
+     static eecrc_t   _crc( eeoffset_t from, unsigned count, eecrc_t crc );
+
+#if EEVALUES_CONF_SCHEMA
+     static boolean   _legacy_valid( eeoffset_t base, EeIdent id, unsigned * full_size );
+#endif
+};
+
+
+#endif
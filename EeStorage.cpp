@@ -0,0 +1,99 @@
+/** EeStorage.cpp ** Storage back-ends for EeValues **  Oct 2026 **/
+/*
+ *  Only the host MMAP back-end has out-of-line code ; the AVR back-end
+ *  is all inline in EeStorage.h, so for AVR builds this file is empty.
+ */
+
+#include <EeValues.h>
+
+#if EEVALUES_CONF_BACKEND == EEVALUES_BACKEND_MMAP
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+uint8_t *        EeMmapStorage::s_base = NULL;
+unsigned         EeMmapStorage::s_size = 0;
+unsigned         EeMmapStorage::s_write_us = EEVALUES_WRITE_BUSY_US;
+unsigned long *  EeMmapStorage::s_cycles = NULL;
+unsigned long    EeMmapStorage::s_reads = 0;
+unsigned long    EeMmapStorage::s_writes = 0;
+unsigned long    EeMmapStorage::s_busy_us = 0;
+unsigned long    EeMmapStorage::s_busy_polls = 0;
+unsigned long    EeMmapStorage::s_now_us = 0;
+unsigned long    EeMmapStorage::s_ready_us = 0;
+boolean          EeMmapStorage::s_cut_armed = false;
+boolean          EeMmapStorage::s_cut_hit = false;
+unsigned long    EeMmapStorage::s_cut_left = 0;
+eeoffset_t       EeMmapStorage::s_cut_off = 0;
+uint8_t          EeMmapStorage::s_cut_value = 0;
+
+
+/***
+ *   Map 'path' as EEMEM.  A new or short file is extended to 'size' bytes
+ *   and the added bytes are set to 0xFF, as on a blank part.  A longer
+ *   file is never cut ; only its first 'size' bytes are mapped.  Changes
+ *   go straight to the file through the shared mapping.
+ *
+ *   @return true if mapped, false on any system-call failure.
+ */
+/* static */ boolean
+EeMmapStorage::open( const char * path, unsigned size, unsigned write_us )
+{
+    close();
+
+    int  fd = ::open( path, O_RDWR | O_CREAT, 0644 );
+    if( fd < 0 )
+        return( false );
+
+    struct stat  st;
+    if( fstat( fd, &st ) != 0 ||
+        ( (unsigned long) st.st_size < size && ftruncate( fd, size ) != 0 ) )
+    {
+        ::close( fd );
+        return( false );
+    }
+
+    void *  base = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    ::close( fd );
+    if( base == MAP_FAILED )
+        return( false );
+
+    s_base = (uint8_t *) base;
+    s_size = size;
+    s_write_us = write_us;
+    s_ready_us = s_now_us;
+
+    //  Bytes beyond the old end-of-file read as zero ; make them "erased".
+    if( (unsigned long) st.st_size < size )
+        memset( s_base + st.st_size, 0xFF, size - st.st_size );
+
+    s_cycles = (unsigned long *) calloc( size, sizeof(*s_cycles) );
+    if( s_cycles == NULL )
+    {
+        close();
+        return( false );
+    }
+
+    resetCounters();
+    return( true );
+}   /* end EeMmapStorage::open() */
+
+
+/* static */ void
+EeMmapStorage::close(void)
+{
+    if( s_base )
+    {
+        munmap( s_base, s_size );
+        s_base = NULL;
+    }
+
+    free( s_cycles );
+    s_cycles = NULL;
+    s_size = 0;
+}   /* end EeMmapStorage::close() */
+
+#endif  /* EEVALUES_BACKEND_MMAP */
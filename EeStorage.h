@@ -0,0 +1,266 @@
+/** EeStorage.h ** Storage back-ends for EeValues **  Oct 2026 **/
+/*
+ *  EeValues never touches EE-memory directly ; every read and write goes
+ *  through the 'EeStorage' policy selected here at compile time.  Each
+ *  back-end is a struct of static inline methods, so on AVR the calls
+ *  collapse into the very same avr-libc eeprom_*() calls as before and
+ *  cost nothing extra.
+ *
+ *  EEVALUES_BACKEND_AVR    on-chip EEMEM via <avr/eeprom.h>.
+ *  EEVALUES_BACKEND_MMAP   Linux / host.  EEMEM is a file mapped into
+ *                          RAM with mmap().  Writes are counted per byte
+ *                          (wear) and the 3.3 ms busy time is modelled,
+ *                          not slept, so host runs go at full speed.
+ *  EEVALUES_BACKEND_PAGED  external I2C / SPI EEPROM or FRAM, written in
+ *                          page bursts ; see EePagedStorage.h.
+ *
+ *  Define EEVALUES_CONF_BACKEND before including EeValues.h to override
+ *  the default, which is AVR when compiling for AVR, else MMAP.
+ *
+ *  The chosen back-end is 'EeBackend'.  EeValues uses 'EeStorage', which
+ *  is the back-end itself, or the back-end wrapped by I/O counters if
+ *  EEVALUES_CONF_TRACE is set ( see EeTrace.h ) and then by a small RAM
+ *  read cache if EEVALUES_CONF_CACHE_LINES is non-zero ( see
+ *  EeCachedStorage.h ).
+ */
+
+#ifndef _LIBRARIES_EESTORAGE_H
+#define _LIBRARIES_EESTORAGE_H
+
+#define EEVALUES_BACKEND_AVR    1
+#define EEVALUES_BACKEND_MMAP   2
+#define EEVALUES_BACKEND_PAGED  3
+
+#ifndef EEVALUES_CONF_BACKEND
+#if defined(__AVR__)
+#define EEVALUES_CONF_BACKEND   EEVALUES_BACKEND_AVR
+#else
+#define EEVALUES_CONF_BACKEND   EEVALUES_BACKEND_MMAP
+#endif
+#endif  /* EEVALUES_CONF_BACKEND */
+
+/** Data-sheet busy time after writing one EEMEM byte, in micro-seconds. */
+#define EEVALUES_WRITE_BUSY_US  3300
+
+
+/* ------------------------------------------------------------------- */
+
+#if EEVALUES_CONF_BACKEND == EEVALUES_BACKEND_AVR
+
+#include <avr/eeprom.h>
+
+struct EeAvrStorage
+{
+     static uint8_t   readByte( eeoffset_t off )
+                        { return eeprom_read_byte( (const uint8_t *) (uintptr_t) off ); }
+     static uint32_t  readDword( eeoffset_t off )
+                        { return eeprom_read_dword( (const uint32_t *) (uintptr_t) off ); }
+     static void      readBlock( void * dst, eeoffset_t off, size_t n )
+                        { eeprom_read_block( dst, (const void *) (uintptr_t) off, n ); }
+
+     static void      writeByte( eeoffset_t off, uint8_t value )
+                        { eeprom_write_byte( (uint8_t *) (uintptr_t) off, value ); }
+     static void      writeBlock( eeoffset_t off, const void * src, size_t n )
+                        { eeprom_write_block( src, (void *) (uintptr_t) off, n ); }
+     static void      fill( eeoffset_t off, uint8_t value, size_t n )
+                        {
+                            for( ; n > 0 ; --n )
+                                eeprom_write_byte( (uint8_t *) (uintptr_t) off++, value );
+                        }
+
+     //  True if a write would start at once, without busy-waiting.
+     static boolean   isReady(void) { return eeprom_is_ready(); }
+
+     //  Return total size of EEMEM, i.e. E2END + 1.
+     static unsigned long  size(void) { return E2END + 1; }
+};
+
+//  EEMEM size known at compile time, e.g. for EeLayout.
+#define EEVALUES_EE_SIZE    (E2END + 1)
+
+typedef EeAvrStorage    EeBackend;
+
+/* ------------------------------------------------------------------- */
+
+#elif EEVALUES_CONF_BACKEND == EEVALUES_BACKEND_MMAP
+
+#include <string.h>
+
+//  Size the host image is expected to have ; open() may still pick any.
+#ifndef EEVALUES_CONF_MMAP_SIZE
+#define EEVALUES_CONF_MMAP_SIZE     4096
+#endif
+
+#define EEVALUES_EE_SIZE    EEVALUES_CONF_MMAP_SIZE
+
+/** Modelled time one isReady() poll takes while EEMEM is busy, in micro-seconds. */
+#ifndef EEVALUES_CONF_MMAP_POLL_US
+#define EEVALUES_CONF_MMAP_POLL_US  100
+#endif
+
+class EeMmapStorage
+{
+   public :
+     //  Map (and create if needed) 'path' as an EEMEM of 'size' bytes.  New
+     //  bytes read as 0xFF, like a blank part.  'write_us' is modelled busy
+     //  time per byte written.  Returns false if file can't be mapped.
+     static boolean   open( const char * path, unsigned size = EEVALUES_EE_SIZE, unsigned write_us = EEVALUES_WRITE_BUSY_US );
+     static void      close(void);
+
+     static uint8_t   readByte( eeoffset_t off )
+                        { ++s_reads; return s_base[off]; }
+     static uint32_t  readDword( eeoffset_t off )
+                        { uint32_t v; s_reads += sizeof(v); memcpy( &v, s_base + off, sizeof(v) ); return v; }
+     static void      readBlock( void * dst, eeoffset_t off, size_t n )
+                        { s_reads += n; memcpy( dst, s_base + off, n ); }
+
+     static void      writeByte( eeoffset_t off, uint8_t value )
+                        {
+                            if( s_cut_armed && _power_cut( off, value ) )
+                                return;
+                            //  Waits out the last write cycle, as eeprom_write_byte() does.
+                            if( s_now_us < s_ready_us )
+                                s_now_us = s_ready_us;
+                            s_ready_us = s_now_us + s_write_us;
+                            s_base[off] = value;
+                            ++s_writes;
+                            s_busy_us += s_write_us;
+                            ++s_cycles[off];
+                        }
+     static void      writeBlock( eeoffset_t off, const void * src, size_t n )
+                        {
+                            const uint8_t * p = (const uint8_t *) src;
+                            for( ; n > 0 ; --n )
+                                writeByte( off++, *p++ );
+                        }
+     static void      fill( eeoffset_t off, uint8_t value, size_t n )
+                        {
+                            for( ; n > 0 ; --n )
+                                writeByte( off++, value );
+                        }
+
+     //  Busy time is modelled on a clock of its own, not slept.  A write
+     //  keeps EEMEM busy for 'write_us' ; each isReady() poll that finds it
+     //  busy takes EEVALUES_CONF_MMAP_POLL_US of that clock, and elapse()
+     //  passes time for other work, e.g. the rest of loop().
+     static boolean   isReady(void)
+                        {
+                            if( s_now_us >= s_ready_us )
+                                return( true );
+                            ++s_busy_polls;
+                            s_now_us += EEVALUES_CONF_MMAP_POLL_US;
+                            return( false );
+                        }
+     static void      elapse( unsigned long us ) { s_now_us += us; }
+
+     static unsigned long  size(void) { return s_size; }
+
+     //  Direct access to the mapped image, e.g. to seed or inspect it.
+     static uint8_t * image(void) { return s_base; }
+
+     //  Counters since open() or resetCounters().
+     static unsigned long  bytesRead(void) { return s_reads; }
+     static unsigned long  bytesWritten(void) { return s_writes; }
+     static unsigned long  busyMicros(void) { return s_busy_us; }
+     static unsigned long  busyPolls(void) { return s_busy_polls; }
+     static void      resetCounters(void) { s_reads = s_writes = s_busy_us = s_busy_polls = 0; }
+
+     //  Write cycles seen by one EEMEM byte since open().
+     static unsigned long  writeCycles( eeoffset_t off ) { return s_cycles[off]; }
+
+     //  Power-loss model, for torture tests.  After 'n' more byte writes
+     //  land, power is gone: every later write is dropped until
+     //  powerRestore().  powerLost() then gives offset and intended value
+     //  of the first dropped write, i.e. the byte a real part would tear.
+     static void      cutPowerAfter( unsigned long n ) { s_cut_armed = true; s_cut_left = n; s_cut_hit = false; }
+     static void      powerRestore(void) { s_cut_armed = false; }
+     static boolean   powerLost( eeoffset_t * off, uint8_t * value )
+                        {
+                            if( s_cut_hit ) { *off = s_cut_off; *value = s_cut_value; }
+                            return( s_cut_hit );
+                        }
+
+   private :
+     static boolean   _power_cut( eeoffset_t off, uint8_t value )
+                        {
+                            if( s_cut_left > 0 )
+                            {
+                                --s_cut_left;
+                                return( false );
+                            }
+                            if( ! s_cut_hit )
+                            {
+                                s_cut_hit = true;
+                                s_cut_off = off;
+                                s_cut_value = value;
+                            }
+                            return( true );
+                        }
+
+     static uint8_t *        s_base;
+     static unsigned         s_size;
+     static unsigned         s_write_us;
+     static unsigned long *  s_cycles;
+     static unsigned long    s_reads;
+     static unsigned long    s_writes;
+     static unsigned long    s_busy_us;
+     static unsigned long    s_busy_polls;       // isReady() calls that found it busy
+     static unsigned long    s_now_us;           // modelled clock
+     static unsigned long    s_ready_us;         // end of the current write cycle
+     static boolean          s_cut_armed;
+     static boolean          s_cut_hit;
+     static unsigned long    s_cut_left;
+     static eeoffset_t       s_cut_off;
+     static uint8_t          s_cut_value;
+};
+
+typedef EeMmapStorage   EeBackend;
+
+/* ------------------------------------------------------------------- */
+
+#elif EEVALUES_CONF_BACKEND == EEVALUES_BACKEND_PAGED
+
+#include "EePagedStorage.h"
+
+#ifndef EEVALUES_CONF_PAGED_BUS
+#error "EEVALUES_BACKEND_PAGED needs EEVALUES_CONF_PAGED_BUS, e.g. EeI2cBus< 0x50, 64, 32768UL >"
+#endif
+
+typedef EePagedStorage< EEVALUES_CONF_PAGED_BUS >  EeBackend;
+
+#define EEVALUES_EE_SIZE    (EeBackend::SIZE)
+
+#else
+#error "EEVALUES_CONF_BACKEND names an unknown back-end."
+#endif
+
+/* ------------------------------------------------------------------- */
+
+/**  Lines in the RAM read cache ; 0 turns the cache off. */
+#ifndef EEVALUES_CONF_CACHE_LINES
+#define EEVALUES_CONF_CACHE_LINES       0
+#endif
+
+/**  Bytes per cache line, a power of 2. */
+#ifndef EEVALUES_CONF_CACHE_LINE_SIZE
+#define EEVALUES_CONF_CACHE_LINE_SIZE   8
+#endif
+
+#include "EeTrace.h"
+
+//  Tracing sits below the cache, so it counts real EEMEM traffic.
+#if EEVALUES_CONF_TRACE
+typedef EeTracedStorage< EeBackend >    _EeDevice;
+#else
+typedef EeBackend   _EeDevice;
+#endif
+
+#if EEVALUES_CONF_CACHE_LINES
+#include "EeCachedStorage.h"
+typedef EeCachedStorage< _EeDevice, EEVALUES_CONF_CACHE_LINE_SIZE, EEVALUES_CONF_CACHE_LINES >  EeStorage;
+#else
+typedef _EeDevice   EeStorage;
+#endif
+
+
+#endif
@@ -0,0 +1,261 @@
+/** EeSuperblock.cpp ** Directory of records kept in EEMEM **  Oct 2026 **/
+
+#include <EeSuperblock.h>
+
+#if EEVALUES_CONF_SUPERBLOCK
+
+#include <string.h>
+
+/* ------------------------------------------------------------------- */
+
+//  Header as the superblock stores it ; CRC is filled in by _commit().
+/* static */ void
+EeSuperblock::_header( EeValues::EeHeader * hdr )
+{
+    hdr->m_crc = 0;
+#if _EEVALUES_HDR_FORMAT
+    hdr->m_format = _EEVALUES_FORMAT;
+#endif
+#if EEVALUES_CONF_SCHEMA
+    hdr->m_schema = 0;
+#endif
+    hdr->m_full_size = EeSuperblock::SIZE;
+    hdr->m_ident = EeSuperblock::IDENT;
+}
+
+
+/* static */ boolean
+EeSuperblock::isValid(void)
+{
+    return( isFormatted() && EeValues::_is_crc_valid( OFFSET, SIZE ) );
+}
+
+
+/* static */ boolean
+EeSuperblock::isFormatted(void)
+{
+    return( EeStorage::readDword( OFFSET + offsetof(EeValues::EeHeader, m_ident) ) == (EeIdent) IDENT &&
+            EeValues::_stored_size( OFFSET ) == SIZE );
+}
+
+
+boolean
+EeSuperblock::lookup( EeIdent id, Entry * entry )
+{
+    EE_TRACE_OP( EE_OP_FIND );
+
+    if( ! isFormatted() )
+        return( false );
+
+    for( uint8_t  k = 0 ; k < ENTRIES ; ++k )
+    {
+        if( EeStorage::readDword( _entry_offset( k ) ) == id &&
+            _read_entry( k, entry ) )
+            return( true );
+    }
+
+    return( false );
+}   /* end EeSuperblock::lookup() */
+
+
+/***
+ *   Point the entry for 'id' at 'offset'.  Uses the entry 'id' already
+ *   has, else the first free one ; an entry that fails its check counts
+ *   as free.  With no superblock header there, one is formatted first.
+ *   A record lying over the superblock is left alone: it has no entry.
+ *
+ *   @return false if the record overlaps the superblock, the superblock
+ *   can't be formatted, or there is no entry to spare.
+ */
+boolean
+EeSuperblock::update( EeIdent id, eeoffset_t offset, eesize_t full_size )
+{
+    if( id == (EeIdent) IDENT || id == 0xFFFFFFFFUL ||
+        ( offset < (unsigned long) END && (unsigned long) offset + full_size > OFFSET ) )
+        return( false );
+
+    EE_TRACE_OP( EE_OP_WRITE );
+
+    if( ! isFormatted() && ! format() )
+        return( false );
+
+    int  free_k = -1;
+
+    for( uint8_t  k = 0 ; k < ENTRIES ; ++k )
+    {
+        Entry  have;
+        const boolean  good = _read_entry( k, &have );
+
+        if( good && have.m_ident == id )
+        {
+            free_k = k;
+            break;
+        }
+        if( free_k < 0 && ( ! good || have.m_ident == 0xFFFFFFFFUL ) )
+            free_k = k;
+    }
+
+    if( free_k < 0 )
+        return( false );
+
+    Entry  entry;
+    entry.m_ident = id;
+    entry.m_offset = offset;
+    entry.m_full_size = full_size;
+    entry.m_check = _check( entry );
+
+    _commit( (uint8_t) free_k, entry );
+    return( true );
+}   /* end EeSuperblock::update() */
+
+
+void
+EeSuperblock::remove( EeIdent id, eeoffset_t offset )
+{
+    if( ! isFormatted() )
+        return;
+
+    for( uint8_t  k = 0 ; k < ENTRIES ; ++k )
+    {
+        Entry  have;
+
+        if( _read_entry( k, &have ) && have.m_ident == id && have.m_offset == offset )
+        {
+            EE_TRACE_OP( EE_OP_ERASE );
+
+            Entry  blank;
+            memset( &blank, 0xFF, sizeof(blank) );
+            _commit( k, blank );
+            return;
+        }
+    }
+}   /* end EeSuperblock::remove() */
+
+
+/***
+ *   findHeader() only reads, so an entry lost to a torn update, or never
+ *   written, stays lost until the record is next written.  Call this
+ *   after a findHeader() that succeeded to put it back now ; an entry
+ *   that is already right costs reads only.
+ *
+ *   @return false if 'rec' isn't valid where it points, or the
+ *   superblock is full.
+ */
+/* static */ boolean
+EeSuperblock::repair( const EeValues & rec )
+{
+    const eeoffset_t  base = rec.eeOffsetOfHeader();
+    const eesize_t    full_size = EeValues::_stored_size( base );
+
+    if( EeStorage::readDword( base + offsetof(EeValues::EeHeader, m_ident) ) != rec.ident() ||
+        ! EeValues::_is_crc_valid( base, full_size ) )
+        return( false );
+
+    return( update( rec.ident(), base, full_size ) );
+}   /* end EeSuperblock::repair() */
+
+
+/***
+ *   A sketch that turns the superblock on may still hold records where
+ *   it goes.  Any valid record reaching into [OFFSET, END) is kept, and
+ *   the superblock is not formatted.
+ *
+ *   @return false if refused.
+ */
+boolean
+EeSuperblock::format(void)
+{
+    if( _region_in_use() )
+        return( false );
+
+    EeValues::EeHeader  hdr;
+    _header( &hdr );
+
+    EeStorage::fill( _entry_offset( 0 ), 0xFF, ENTRIES * sizeof(Entry) );
+    EeStorage::writeBlock( OFFSET, &hdr, sizeof(hdr) );
+
+    Entry  blank;
+    memset( &blank, 0xFF, sizeof(blank) );
+    _commit( 0, blank );
+    return( true );
+}   /* end EeSuperblock::format() */
+
+/* ------------------------------------------------------------------- */
+
+//  Check of an entry's fields, so one torn entry can be told apart.
+/* static */ eecrc_t
+EeSuperblock::_check( const Entry & entry )
+{
+    return( EeCrc::block( EeCrc::seed(), (const uint8_t *) &entry, offsetof(Entry, m_check) ) );
+}
+
+
+//  Some valid record, other than a superblock, lies over [OFFSET, END)?
+/* static */ boolean
+EeSuperblock::_region_in_use(void)
+{
+    const unsigned long  from = OFFSET > EEVALUES_MAX_FULL_SIZE ? OFFSET - EEVALUES_MAX_FULL_SIZE : 0;
+
+    for( unsigned long  p = from ; p < (unsigned long) END ; ++p )
+    {
+        if( p + EeValues::HEADER_SIZE > EeStorage::size() )
+            break;
+
+        const eeoffset_t  base = (eeoffset_t) p;
+        const unsigned    full_size = EeValues::_stored_size( base );
+
+        if( p + full_size > OFFSET &&
+            EeStorage::readDword( base + offsetof(EeValues::EeHeader, m_ident) ) != (EeIdent) IDENT &&
+            EeValues::_is_crc_valid( base, full_size ) )
+            return( true );
+    }
+
+    return( false );
+}
+
+
+//  Read entry 'k' ; true if it is in use and passes its check.
+/* static */ boolean
+EeSuperblock::_read_entry( uint8_t k, Entry * entry )
+{
+    EeStorage::readBlock( entry, _entry_offset( k ), sizeof(*entry) );
+
+    return( entry->m_ident != 0xFFFFFFFFUL && entry->m_check == _check( *entry ) );
+}
+
+
+/***
+ *   Store 'entry' as entry 'k' and the CRC to match.  The CRC is run over
+ *   the stored entries with 'k' replaced, so no RAM copy of the whole
+ *   superblock is needed.  Entry first, CRC second: power lost part way
+ *   leaves entry 'k' failing its check and a bad CRC, but every other
+ *   entry still passes its own, and the next update sets the CRC right.
+ */
+/* static */ void
+EeSuperblock::_commit( uint8_t k, const Entry & entry )
+{
+    EeValues::EeHeader  hdr;
+    _header( &hdr );
+
+    eecrc_t  crc = EeCrc::block( EeCrc::seed(),
+                                 (const uint8_t *) &hdr + sizeof(hdr.m_crc),
+                                 sizeof(hdr) - sizeof(hdr.m_crc) );
+
+    for( uint8_t  i = 0 ; i < ENTRIES ; ++i )
+    {
+        Entry  e;
+
+        if( i == k )
+            e = entry;
+        else
+            EeStorage::readBlock( &e, _entry_offset( i ), sizeof(e) );
+
+        crc = EeCrc::block( crc, (const uint8_t *) &e, sizeof(e) );
+    }
+
+    unsigned  skipped = 0;
+    EeValues::_write_changed( _entry_offset( k ), (const uint8_t *) &entry, sizeof(entry), &skipped );
+    EeValues::_write_changed( OFFSET + offsetof(EeValues::EeHeader, m_crc), (const uint8_t *) &crc, sizeof(crc), &skipped );
+}   /* end EeSuperblock::_commit() */
+
+#endif  /* EEVALUES_CONF_SUPERBLOCK */
@@ -0,0 +1,100 @@
+/** EeSuperblock.h ** Directory of records kept in EEMEM **  Oct 2026 **/
+/*
+ *  findHeader() in hunt mode scans EEMEM byte by byte, so boot time grows
+ *  with the image.  With EEVALUES_CONF_SUPERBLOCK set to a number of
+ *  entries, a small directory of ( ident, offset, size ) is kept at
+ *  EEVALUES_CONF_SUPERBLOCK_OFFSET and findHeader() becomes a read of the
+ *  directory plus one CRC check of the record it points at.
+ *
+ *  The superblock is itself an ordinary record, ident "EeSB", so its own
+ *  CRC protects it and EeDirectory lists it.  It is kept up to date by
+ *  EeValues: writeToEe() and writeChangedToEe() add or move the record's
+ *  entry after the record is written, and eraseEeHeader() drops the entry
+ *  before the header goes.  An entry is rewritten only if it changed.
+ *
+ *  Nothing trusts it blindly.  Each entry carries a check of its own, and
+ *  the record's CRC goes down after the entry, so power lost part way
+ *  through an update costs only the entry being written: lookup() skips
+ *  an entry that fails its check, and the rest still answer.  If there is
+ *  no good entry, or its record fails its header check, findHeader()
+ *  falls back to the byte scan.  Finding a record never writes EEMEM ;
+ *  after a findHeader() that had to scan, repair() puts the entry back.
+ *
+ *  Records must not be placed over it: start them at EeSuperblock::END.
+ *  One that is gets no entry, and while a valid record lies there the
+ *  superblock is not formatted, so a sketch that turns it on doesn't
+ *  lose the records it already holds ; findHeader() just scans for them.
+ */
+
+#ifndef _LIBRARIES_EESUPERBLOCK_H
+#define _LIBRARIES_EESUPERBLOCK_H
+
+#include "EeValues.h"
+
+/**  Entries in the superblock ; 0 for no superblock. */
+#ifndef EEVALUES_CONF_SUPERBLOCK
+#define EEVALUES_CONF_SUPERBLOCK            0
+#endif
+
+/**  EE offset of the superblock. */
+#ifndef EEVALUES_CONF_SUPERBLOCK_OFFSET
+#define EEVALUES_CONF_SUPERBLOCK_OFFSET     0
+#endif
+
+#if EEVALUES_CONF_SUPERBLOCK
+
+class EeSuperblock
+{
+   public :
+     //  Packed, so the stored layout is the same on every build.
+     struct PACKED Entry {
+        EeIdent        m_ident;            // all 0xFF for a free entry.
+        eeoffset_t     m_offset;
+        eesize_t       m_full_size;
+        eecrc_t        m_check;            // EeCrc of the fields above.
+     };
+
+     enum { IDENT   = MK4CODE('E','e','S','B'),
+            ENTRIES = EEVALUES_CONF_SUPERBLOCK,
+            OFFSET  = EEVALUES_CONF_SUPERBLOCK_OFFSET,
+            SIZE    = EeValues::HEADER_SIZE + EEVALUES_CONF_SUPERBLOCK * sizeof(Entry),
+            END     = OFFSET + SIZE };
+
+     static_assert( SIZE <= EEVALUES_MAX_FULL_SIZE, "EeSuperblock: too many entries for one record" );
+
+     //  Superblock present with a good CRC?
+     static boolean   isValid(void);
+
+     //  Superblock header present, whatever the state of its entries?
+     static boolean   isFormatted(void);
+
+     //  Entry for 'id', if the superblock holds one that passes its check.
+     static boolean   lookup( EeIdent id, Entry * entry );
+
+     //  Add or move the entry for 'id'.  False if the superblock is full.
+     static boolean   update( EeIdent id, eeoffset_t offset, eesize_t full_size );
+
+     //  Drop the entry for 'id' if it is at 'offset'.
+     static void      remove( EeIdent id, eeoffset_t offset );
+
+     //  Point the entry for 'rec' at where its header is now, if the
+     //  record there is valid.  For use after findHeader().
+     static boolean   repair( const EeValues & rec );
+
+     //  Write an empty superblock.  False, and nothing written, if a
+     //  valid record lies where it goes.
+     static boolean   format(void);
+
+   protected :
+     static eeoffset_t  _entry_offset( uint8_t k ) { return OFFSET + EeValues::HEADER_SIZE + k * sizeof(Entry); }
+     static void        _header( EeValues::EeHeader * hdr );
+     static eecrc_t     _check( const Entry & entry );
+     static boolean     _read_entry( uint8_t k, Entry * entry );
+     static boolean     _region_in_use(void);
+     static void        _commit( uint8_t k, const Entry & entry );
+};
+
+#endif  /* EEVALUES_CONF_SUPERBLOCK */
+
+
+#endif
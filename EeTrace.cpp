@@ -0,0 +1,119 @@
+/** EeTrace.cpp ** Instrumentation hooks, I/O counters and wear histogram **  Oct 2026 **/
+/*
+ *  Empty unless EEVALUES_CONF_TRACE is set ; see EeTrace.h.
+ */
+
+#include <EeValues.h>
+
+#if EEVALUES_CONF_TRACE
+
+#include <string.h>
+
+EeTraceHook    EeTrace::s_hook = NULL;
+uint8_t        EeTrace::s_op = EE_OP_OTHER;
+unsigned long  EeTrace::s_read[ EE_OP_COUNT ];
+unsigned long  EeTrace::s_written[ EE_OP_COUNT ];
+#if EEVALUES_CONF_TRACE_WEAR
+uint32_t       EeTrace::s_wear[ WEAR_BUCKETS ];
+#endif
+
+/* ------------------------------------------------------------------- */
+
+
+/* static */ void
+EeTrace::resetCounters(void)
+{
+    memset( s_read, 0, sizeof(s_read) );
+    memset( s_written, 0, sizeof(s_written) );
+}
+
+
+/***
+ *   Count 'n' bytes written at 'offset' against the current operation,
+ *   and one write to each wear bucket they touch.
+ */
+/* static */ void
+EeTrace::_write( eeoffset_t offset, size_t n )
+{
+    s_written[s_op] += n;
+
+#if EEVALUES_CONF_TRACE_WEAR
+    if( n == 0 )
+        return;
+
+    unsigned        b = offset / EEVALUES_CONF_TRACE_WEAR;
+    const unsigned  last = (offset + n - 1) / EEVALUES_CONF_TRACE_WEAR;
+
+    for( ; b <= last && b < WEAR_BUCKETS ; ++b )
+        ++s_wear[b];
+#else
+    (void) offset;
+#endif
+}   /* end EeTrace::_write() */
+
+
+#if EEVALUES_CONF_TRACE_WEAR
+
+/***
+ *   Find the most written bucket.
+ *
+ *   @param offset if not NULL, receives EE offset of that bucket.
+ *   @return its write count.
+ */
+/* static */ uint32_t
+EeTrace::hottest( eeoffset_t * offset )
+{
+    unsigned  best = 0;
+
+    for( unsigned  b = 1 ; b < WEAR_BUCKETS ; ++b )
+        if( s_wear[b] > s_wear[best] )
+            best = b;
+
+    if( offset )
+        *offset = (eeoffset_t) (best * EEVALUES_CONF_TRACE_WEAR);
+
+    return( s_wear[best] );
+}   /* end EeTrace::hottest() */
+
+
+/* static */ void
+EeTrace::resetWear(void)
+{
+    memset( s_wear, 0, sizeof(s_wear) );
+}
+
+#endif  /* EEVALUES_CONF_TRACE_WEAR */
+
+/* ------------------------------------------------------------------- */
+
+#if defined(ARDUINO)
+
+//  In PROGMEM, like the literals below, so tracing doesn't cost SRAM.
+static const char  s_event_names[ EE_EV_COUNT ][ 9 ] PROGMEM =
+{
+    "scan", "ident", "crc", "scan-end", "load", "write", "erase"
+};
+
+/***
+ *   Ready-made hook printing one line per event to 'Serial', e.g.
+ *   "EE crc $00A 18 1".  Serial is slow, so expect timing to stretch.
+ */
+/* static */ void
+EeTrace::printHook( uint8_t event, eeoffset_t offset, unsigned count, uint32_t arg )
+{
+    Serial.print( F("EE ") );
+    if( event < EE_EV_COUNT )
+        Serial.print( (const __FlashStringHelper *) s_event_names[event] );
+    else
+        Serial.print( '?' );
+    Serial.print( F(" $") );
+    Serial.print( offset, HEX );
+    Serial.print( ' ' );
+    Serial.print( count );
+    Serial.print( ' ' );
+    Serial.println( arg, HEX );
+}   /* end EeTrace::printHook() */
+
+#endif  /* ARDUINO */
+
+#endif  /* EEVALUES_CONF_TRACE */
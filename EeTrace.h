@@ -0,0 +1,155 @@
+/** EeTrace.h ** Instrumentation hooks, I/O counters and wear histogram **  Oct 2026 **/
+/*
+ *  Replaces the old EEVALUES_DEBUG Serial.print() blocks.  With
+ *  EEVALUES_CONF_TRACE left at 0, every EE_TRACE_*() macro expands to
+ *  nothing and EeStorage is the plain back-end: no code, no RAM.
+ *
+ *  With EEVALUES_CONF_TRACE 1:
+ *    - EeValues reports events ( scan begin / end, ident match, CRC
+ *      checked, bytes written, erase ) to a hook set by EeTrace::setHook().
+ *      The hook runs inline, so keep it short ; EeTrace::printHook sends
+ *      them to Serial much as the old debug build did.
+ *    - EeStorage becomes EeTracedStorage< EeBackend >, which counts the
+ *      EEMEM bytes read and written, charged to the operation in progress
+ *      ( find, validate, load, write, erase, other ).  Counts are bytes
+ *      reaching the back-end, below any read cache.
+ *    - If EEVALUES_CONF_TRACE_WEAR is non-zero, each write also bumps a
+ *      counter for every bucket of that many bytes it touches.  With a
+ *      bucket of 1 this is the exact per-byte write count ; RAM cost is
+ *      4 * EEVALUES_EE_SIZE / EEVALUES_CONF_TRACE_WEAR bytes.
+ *
+ *  Wear gives the field lifetime of a hot record: run for a known time,
+ *  take hottest(), and divide the part's endurance ( 100000 cycles for
+ *  AVR EEMEM ) by the rate.
+ */
+
+#ifndef _LIBRARIES_EETRACE_H
+#define _LIBRARIES_EETRACE_H
+
+/**  0/1 to compile instrumentation out / in. */
+#ifndef EEVALUES_CONF_TRACE
+#define EEVALUES_CONF_TRACE         0
+#endif
+
+/**  Bytes per wear-histogram bucket ; 0 for no histogram. */
+#ifndef EEVALUES_CONF_TRACE_WEAR
+#define EEVALUES_CONF_TRACE_WEAR    0
+#endif
+
+
+enum EeTraceEvent
+{
+    EE_EV_SCAN_BEGIN = 0,   // offset = scan start, arg = ident
+    EE_EV_IDENT_MATCH,      // offset = header
+    EE_EV_CRC,              // offset = header, count = record size, arg = 1 if valid
+    EE_EV_SCAN_END,         // offset = header found, count = 0 if not found
+    EE_EV_LOAD,             // offset = header, count = user bytes, arg = 1 if valid
+    EE_EV_WRITE,            // offset = header, count = bytes written, arg = bytes skipped
+    EE_EV_ERASE,            // offset, count = bytes written, arg = fill value
+    EE_EV_COUNT
+};
+
+enum EeTraceOp
+{
+    EE_OP_OTHER = 0,
+    EE_OP_FIND,             // ident scan, directory scan
+    EE_OP_VALIDATE,         // CRC check of a record in EEMEM
+    EE_OP_LOAD,             // readToUser(), loadIfValid()
+    EE_OP_WRITE,            // writeToEe(), writeChangedToEe(), commits
+    EE_OP_ERASE,
+    EE_OP_COUNT
+};
+
+
+#if EEVALUES_CONF_TRACE
+
+typedef void (*EeTraceHook)( uint8_t event, eeoffset_t offset, unsigned count, uint32_t arg );
+
+class EeTrace
+{
+   public :
+     static void        setHook( EeTraceHook hook ) { s_hook = hook; }
+
+     static void        event( uint8_t ev, eeoffset_t offset, unsigned count, uint32_t arg )
+                            {
+                                if( s_hook )
+                                    s_hook( ev, offset, count, arg );
+                            }
+
+     static unsigned long  bytesRead( uint8_t op ) { return s_read[op]; }
+     static unsigned long  bytesWritten( uint8_t op ) { return s_written[op]; }
+     static void        resetCounters(void);
+
+     static uint8_t     currentOp(void) { return s_op; }
+
+#if EEVALUES_CONF_TRACE_WEAR
+     enum { WEAR_BUCKETS = (EEVALUES_EE_SIZE + EEVALUES_CONF_TRACE_WEAR - 1) / EEVALUES_CONF_TRACE_WEAR };
+
+     static uint32_t    wear( unsigned bucket ) { return s_wear[bucket]; }
+     static uint32_t    hottest( eeoffset_t * offset );
+     static void        resetWear(void);
+#endif
+
+#if defined(ARDUINO)
+     static void        printHook( uint8_t event, eeoffset_t offset, unsigned count, uint32_t arg );
+#endif
+
+     //  Called by EeTracedStorage.
+     static void        _read( size_t n ) { s_read[s_op] += n; }
+     static void        _write( eeoffset_t offset, size_t n );
+
+     static EeTraceHook    s_hook;
+     static uint8_t        s_op;
+     static unsigned long  s_read[ EE_OP_COUNT ];
+     static unsigned long  s_written[ EE_OP_COUNT ];
+#if EEVALUES_CONF_TRACE_WEAR
+     static uint32_t       s_wear[ WEAR_BUCKETS ];
+#endif
+};
+
+
+/***
+ *   Charges I/O to 'op' until it goes out of scope.  Nested scopes ( a
+ *   find that validates ) charge the innermost, then restore the outer.
+ */
+class EeTraceScope
+{
+   public :
+     EeTraceScope( uint8_t op ) { m_prev = EeTrace::s_op; EeTrace::s_op = op; }
+     ~EeTraceScope() { EeTrace::s_op = m_prev; }
+
+   private :
+     uint8_t    m_prev;
+};
+
+
+template< class BASE >
+struct EeTracedStorage : public BASE
+{
+     static uint8_t   readByte( eeoffset_t off )
+                        { EeTrace::_read( 1 ); return BASE::readByte( off ); }
+     static uint32_t  readDword( eeoffset_t off )
+                        { EeTrace::_read( 4 ); return BASE::readDword( off ); }
+     static void      readBlock( void * dst, eeoffset_t off, size_t n )
+                        { EeTrace::_read( n ); BASE::readBlock( dst, off, n ); }
+
+     static void      writeByte( eeoffset_t off, uint8_t value )
+                        { EeTrace::_write( off, 1 ); BASE::writeByte( off, value ); }
+     static void      writeBlock( eeoffset_t off, const void * src, size_t n )
+                        { EeTrace::_write( off, n ); BASE::writeBlock( off, src, n ); }
+     static void      fill( eeoffset_t off, uint8_t value, size_t n )
+                        { EeTrace::_write( off, n ); BASE::fill( off, value, n ); }
+};
+
+#define EE_TRACE_EVENT(ev, off, n, arg)     EeTrace::event( (ev), (off), (n), (arg) )
+#define EE_TRACE_OP(op)                     EeTraceScope  _ee_trace_scope( op )
+
+#else
+
+#define EE_TRACE_EVENT(ev, off, n, arg)     ((void) 0)
+#define EE_TRACE_OP(op)                     ((void) 0)
+
+#endif  /* EEVALUES_CONF_TRACE */
+
+
+#endif
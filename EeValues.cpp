@@ -13,29 +13,20 @@
  *    or the CRC is invalid, then the data-record cannot be found.
  *  =else
  *    Method TryRead() is told where to look.  If the record changes often,
- *    a wear-leveling scheme should be considered.  A client field could
- *    track the number of updates.  When it overflows, the record is moved.
- *    Client code would look for it at "base + K * totalSize(void)" locations.
+ *    a wear-leveling scheme should be considered.  EeRing does this: it
+ *    rotates commits over "base + K * totalSize(void)" slots and keeps a
+ *    sequence number so the newest valid slot can be found.
  *  =endif
  *
  *    brian witt    Sept 2013    New.
  *    brian witt    Nov 2013     Fields stored in EE memory now own structure.
  */
 
-/*  Define 0/1 to disable/enable debugging messages to 'Serial' */
-#define EEVALUES_DEBUG  01
-
-#define EEVALUES_DEBUG_CRC  0
-
-#include <crc8.h>
-#include <avr/eeprom.h>
+/*  Debugging is by EE_TRACE_*() hooks, compiled in with EEVALUES_CONF_TRACE ; see EeTrace.h */
 
 #include <EeValues.h>
-
-#if EEVALUES_DEBUG_CRC || EEVALUES_DEBUG
-//   Ardu 1.5: A library doesn't know about other libraries. https://code.google.com/p/arduino/wiki/BuildProcess
-#include "../CnUtils/CnUtils.h"
-#endif
+#include <EeDirectory.h>
+#include <EeSuperblock.h>
 
 /* ------------------------------------------------------------------- */
 
@@ -55,37 +46,8 @@ typedef union
 
 /* ------------------------------------------------------------------- */
 
-#if EEVALUES_DEBUG_CRC
-
-static uint8_t debug_crc8( uint8_t inCrc, uint8_t data )
-{
-    uint8_t  updated = ::Crc8( inCrc, data );
-
-    //  Arduino serial-port debug.
-    Serial.print( "crc8(" );
-    Serial.print( data, HEX );
-    Serial.print( ") --> " );
-    Serial.println( updated, HEX );
-
-    return( updated );
-}
-
-static uint8_t debug_Crc8Block( uint8_t inCrc, const uint8_t *data, uint8_t len )
-{
-    while ( len > 0 )
-    {
-        Serial.print( "blk-" );
-        inCrc = debug_crc8( inCrc, *data++ );
-        len--;
-    }
-
-    return inCrc;
-}
-
-#define Crc8(inCrc, data)  debug_crc8((inCrc), (data))
-#define Crc8Block(inCrc, ptr, len)   debug_Crc8Block( (inCrc), (ptr), (len) )
-
-#endif
+#define CRC_UPDATE(inCrc, data)         EeCrc::update((inCrc), (data))
+#define CRC_BLOCK(inCrc, ptr, len)      EeCrc::block( (inCrc), (ptr), (len) )
 
 /* ------------------------------------------------------------------- */
 
@@ -94,7 +56,13 @@ EeValues::EeValues( EeIdent id )
 {
     // GCC 4.4 can't initialize a field inside an instance-var structure, so do it manually.
     m_header.m_ident = id;
-    m_header.m_crc8 = 0;
+    m_header.m_crc = 0;
+#if _EEVALUES_HDR_FORMAT
+    m_header.m_format = _EEVALUES_FORMAT;
+#endif
+#if EEVALUES_CONF_SCHEMA
+    m_header.m_schema = 0;
+#endif
     m_header.m_full_size = 0;
 
     m_start_offset = 0;
@@ -102,15 +70,86 @@ EeValues::EeValues( EeIdent id )
 }
 
 
-/* static */ unsigned
+/* static */ unsigned long
 EeValues::eeSize()
 {
-    return E2END + 1;    
+    return EeStorage::size();
+}
+
+
+boolean
+EeValues::setUserSize( unsigned siz )
+{
+    if( (unsigned long) siz + sizeof(EeHeader) > EEVALUES_MAX_FULL_SIZE )
+        return( false );
+
+    m_header.m_full_size = (eesize_t) (siz + sizeof(EeHeader));
+    return( true );
+}
+
+
+//  Size field of the header stored at 'base_offset', whatever its width.
+/* static */ eesize_t
+EeValues::_stored_size( eeoffset_t base_offset )
+{
+    eesize_t  full_size;
+    EeStorage::readBlock( &full_size, base_offset + offsetof(EeHeader, m_full_size), sizeof(full_size) );
+    return( full_size );
 }
 
 
 /* ------------------------------------------------------------------- */
 
+/***
+ *   Recompute CRC of the record in EE-memory starting at 'base_offset'
+ *   that is 'full_size' bytes long (header included), and compare with
+ *   the CRC stored in its header.  A size that cannot hold a header, or
+ *   runs past the end of EEMEM, is never valid.  Bytes are fetched in
+ *   small blocks, so a large record costs a few bus transactions per
+ *   16 bytes rather than one per byte.
+ *
+ *   @return true if stored and computed CRC match.
+ */
+/* static */ boolean
+EeValues::_is_crc_valid( eeoffset_t base_offset, unsigned full_size )
+{
+    EE_TRACE_OP( EE_OP_VALIDATE );
+
+    if( full_size < sizeof(EeHeader) ||
+        (unsigned long) base_offset + full_size > EeStorage::size() )
+        return( false );
+
+#if _EEVALUES_HDR_FORMAT
+    //  Written with another CRC kind or header version?  Not ours.
+    if( EeStorage::readByte( base_offset + offsetof(EeHeader, m_format) ) != _EEVALUES_FORMAT )
+        return( false );
+#endif
+
+    eecrc_t  ee_crc;
+    EeStorage::readBlock( &ee_crc, base_offset + offsetof(EeHeader, m_crc), sizeof(ee_crc) );
+
+    //  Remember to skip EE CRC.  We'll compare it afterwards.
+    eeoffset_t  off = base_offset + sizeof(m_header.m_crc);
+    unsigned    siz = full_size - sizeof(m_header.m_crc);
+    eecrc_t     crc = EeCrc::seed();
+    uint8_t     chunk[16];
+
+    while( siz > 0 )
+    {
+        const unsigned  n = siz < sizeof(chunk) ? siz : sizeof(chunk);
+
+        EeStorage::readBlock( chunk, off, n );
+        crc = CRC_BLOCK( crc, chunk, n );
+        off += n;
+        siz -= n;
+    }
+
+    /* Compare EE read-CRC with EE computed CRC.  Is EE-record valid? */
+    EE_TRACE_EVENT( EE_EV_CRC, base_offset, full_size, ee_crc == crc );
+    return( ee_crc == crc );
+}   /* end EeValues::_is_crc_valid() */
+
+
 /***
  *   Go looking for 'ident' header at offset give in EE-memory.
  *   Size is NOT matched, just 'ident'.
@@ -122,7 +161,7 @@ EeValues::eeSize()
 boolean
 EeValues::isHeaderValid(void)
 {
-    register uint8_t  match0;
+    uint8_t  match0;
     uint8_t  match1;
     uint8_t  match2;
     uint8_t  match3;
@@ -134,81 +173,36 @@ EeValues::isHeaderValid(void)
     eeoffset_t  offset      = base_offset + offsetof(EeHeader, m_ident);
 
     {
-        const FourBytes * p = (const FourBytes *) & this->m_header.m_ident;
-        match0 = p->byte.byte0;
-        match1 = p->byte.byte1;
-        match2 = p->byte.byte2;
-        match3 = p->byte.byte3;
+        FourBytes  id;
+        id.dword = this->m_header.m_ident;      // copy, header is packed
+        match0 = id.byte.byte0;
+        match1 = id.byte.byte1;
+        match2 = id.byte.byte2;
+        match3 = id.byte.byte3;
     }
-#if EEVALUES_DEBUG
-    {
-        Serial.print("Looking for \"" );
-
-        Serial.print( (char) (this->m_header.m_ident) );
-        Serial.print( (char) (this->m_header.m_ident >> 8) );
-        Serial.print( (char) (this->m_header.m_ident >> 16) );
-        Serial.print( (char) (this->m_header.m_ident >> 24) );
-
-        Serial.print( "\" at offset $" );
-        printHexWidth( Serial, base_offset, 2 );
-        Serial.println();
-    }
-#endif
+    EE_TRACE_OP( EE_OP_FIND );
+    EE_TRACE_EVENT( EE_EV_SCAN_BEGIN, base_offset, 0, ident() );
 
-    buff.dword = eeprom_read_dword( (const uint32_t *) offset );
+    buff.dword = EeStorage::readDword( offset );
 
     if( (buff.byte.byte0 == match0) &&
         (buff.byte.byte1 == match1) &&
         (buff.byte.byte2 == match2) &&
         (buff.byte.byte3 == match3) )
     {
-#if EEVALUES_DEBUG
-        Serial.println( " .. found Ident-4Code match!" );
-#endif
-        // Found a matching IDENT.
+        EE_TRACE_EVENT( EE_EV_IDENT_MATCH, base_offset, 0, 0 );
 
         // Now check if the EE-CRC is valid by recomputing it and checking for a match....
-        match0 = eeprom_read_byte( (const uint8_t *) (base_offset + offsetof(EeHeader, m_crc8) ) );
-
-        //  Remember to skip EE CRC.  We'll compare it afterwards.
-        uint16_t  off = base_offset + sizeof(m_header.m_crc8);
-        uint8_t   siz = totalSize() - sizeof(m_header.m_crc8);
-        uint8_t   crc = _EEVALUES_CRC_SEED;
-
-        for( ; siz > 0 ; --siz, ++off )
+        if( _is_crc_valid( base_offset, totalSize() ) )
         {
-#if EEVALUES_DEBUG_CRC
-            // DEBUG: prefix crc value with EE address.
-            printHexWidth( Serial, off, 3 );
-            Serial.print( ": " );
-#endif
-            crc = Crc8( crc, eeprom_read_byte( (const uint8_t *) off ) );
-        }
-
-#if EEVALUES_DEBUG
-        Serial.print( " .. EE crc=0x" );
-        Serial.print( match0, HEX );
-        Serial.print( " (EE offset=$" );
-
-        const unsigned  offs = base_offset + offsetof(EeHeader, m_crc8);
-        printHexWidth( Serial, offs, 3 );
-
-        Serial.print( "), computed CRC=0x" );
-        Serial.println( crc, HEX );
-#endif
-        /* Compare EE read-CRC with EE computed CRC.  Is EE-record valid? */
-        if( match0 == crc )
-        {
-#if EEVALUES_DEBUG
-            Serial.println( " .. found CRC match!" );
-#endif
-            m_header.m_full_size = eeprom_read_byte( (const uint8_t *) (base_offset + offsetof(EeHeader, m_full_size)) );
+            m_header.m_full_size = _stored_size( base_offset );
 
             m_start_offset = base_offset;
             found = true;
         }
     }
 
+    EE_TRACE_EVENT( EE_EV_SCAN_END, base_offset, found, 0 );
     return( found );
 }   /* end EeValues::TryRead() */
 
@@ -216,8 +210,8 @@ EeValues::isHeaderValid(void)
 int
 EeValues::readToUser(void)
 {
-    /*          eeprom_read_block (void *__dst, const void *__src, size_t __n)  */
-    eeprom_read_block( userDataPtr(), (void *) eeOffsetOfUserRecord(), userRecordSize() );
+    EE_TRACE_OP( EE_OP_LOAD );
+    EeStorage::readBlock( userDataPtr(), eeOffsetOfUserRecord(), userRecordSize() );
 
     return( userRecordSize() );
 }   // end EeValues::readToUser()
@@ -226,22 +220,106 @@ EeValues::readToUser(void)
 int
 EeValues::readToUser( eeoffset_t ee_offset, void * user_buffer, size_t ee_count )
 {
-#if EEVALUES_DEBUG
-    Serial.print( "readToUser( $" );
-    Serial.print( ee_offset, HEX );
-    Serial.print( ", $" );
-    Serial.print( (unsigned) user_buffer, HEX );
-    Serial.print( ", " );
-    Serial.print( ee_count );
-    Serial.println( ")" );
-#endif
+    EE_TRACE_OP( EE_OP_LOAD );
 
-    eeprom_read_block( user_buffer, (const uint8_t *) ee_offset, ee_count );
+    EeStorage::readBlock( user_buffer, ee_offset, ee_count );
 
     return( ee_count );
 }   /* end EeValues::readToUser() */
 
 
+/***
+ *   Check and load in a single EEMEM pass: the CRC is updated from the
+ *   very bytes copied into the user's buffer, instead of reading the
+ *   record once to validate and again to copy.  Halves boot-time reads.
+ *
+ *   @return true if header matches and CRC is good.
+ */
+boolean
+EeValues::loadIfValid( void )
+{
+    EE_TRACE_OP( EE_OP_LOAD );
+
+    eecrc_t  crc;
+
+    if( ! _load_header( &crc ) )
+        return( false );
+
+    EeStorage::readBlock( userDataPtr(), eeOffsetOfUserRecord(), userRecordSize() );
+    crc = CRC_BLOCK( crc, (const uint8_t *) userDataPtr(), userRecordSize() );
+
+    EE_TRACE_EVENT( EE_EV_LOAD, m_start_offset, userRecordSize(), crc == m_header.m_crc );
+    return( crc == m_header.m_crc );
+}   /* end EeValues::loadIfValid() */
+
+
+boolean
+EeValues::loadIfValid( EeChunkSink sink, void * context, uint8_t * scratch, unsigned scratch_size )
+{
+    EE_TRACE_OP( EE_OP_LOAD );
+
+    eecrc_t  crc;
+
+    if( ! _load_header( &crc ) || scratch_size == 0 )
+        return( false );
+
+    eeoffset_t  off = eeOffsetOfUserRecord();
+    unsigned    pos = 0;
+    unsigned    left = userRecordSize();
+
+    while( left > 0 )
+    {
+        const unsigned  n = left < scratch_size ? left : scratch_size;
+
+        EeStorage::readBlock( scratch, off, n );
+        crc = CRC_BLOCK( crc, scratch, n );
+        sink( context, pos, scratch, n );
+
+        off += n;
+        pos += n;
+        left -= n;
+    }
+
+    EE_TRACE_EVENT( EE_EV_LOAD, m_start_offset, userRecordSize(), crc == m_header.m_crc );
+    return( crc == m_header.m_crc );
+}   /* end EeValues::loadIfValid() */
+
+
+/***
+ *   Read header at eeOffsetOfHeader() and check it is ours: same ident,
+ *   same format, same size as set by setUserSize(), and same schema if
+ *   stored.  On success the
+ *   stored CRC is copied into our header and '*crc' holds the running
+ *   CRC over the header, ready for the user's bytes.
+ */
+boolean
+EeValues::_load_header( eecrc_t * crc )
+{
+    EeHeader  hdr;
+
+    EeStorage::readBlock( &hdr, m_start_offset, sizeof(hdr) );
+
+    if( hdr.m_ident != m_header.m_ident || hdr.m_full_size != m_header.m_full_size ||
+        (unsigned long) m_start_offset + hdr.m_full_size > EeStorage::size() )
+        return( false );
+#if _EEVALUES_HDR_FORMAT
+    if( hdr.m_format != _EEVALUES_FORMAT )
+        return( false );
+#endif
+#if EEVALUES_CONF_SCHEMA
+    if( hdr.m_schema != m_header.m_schema )
+        return( false );
+#endif
+
+    m_header.m_crc = hdr.m_crc;
+
+    *crc = CRC_BLOCK( EeCrc::seed(),
+                      (const uint8_t *) &hdr + sizeof(hdr.m_crc),
+                      sizeof(hdr) - sizeof(hdr.m_crc) );
+    return( true );
+}   /* end EeValues::_load_header() */
+
+
 /***
  *   Just writes the whole object, both EeValues header and the
  *   user's record, into EE-memory.
@@ -255,14 +333,88 @@ EeValues::readToUser( eeoffset_t ee_offset, void * user_buffer, size_t ee_count
 int
 EeValues::writeToEe(void)
 {
+    EE_TRACE_OP( EE_OP_WRITE );
 
-    /*                      eeprom_write_block (const void *_RAM_src, void *_EE_dst, size_t __n)  */
-    eeprom_write_block( (const void *) &this->m_header, (void *) m_start_offset, sizeof(this->m_header) );
-    eeprom_write_block( (const void *) this->userDataPtr(), (void *) eeOffsetOfUserRecord(), userRecordSize() );
+    EeStorage::writeBlock( m_start_offset, (const void *) &this->m_header, sizeof(this->m_header) );
+    EeStorage::writeBlock( eeOffsetOfUserRecord(), (const void *) this->userDataPtr(), userRecordSize() );
 
+    EE_TRACE_EVENT( EE_EV_WRITE, m_start_offset, totalSize(), 0 );
+    _note_written();
     return( totalSize() );
 }   /* end EeValues::writeToEe() */
 
+
+/***
+ *   Differential version of writeToEe().  Each byte of header and user's
+ *   record is compared against EE-memory, and only those that differ are
+ *   written.  A read is cheap, but a write costs 3.3 ms and a wear cycle,
+ *   so bumping one field of a record now costs one write, not totalSize().
+ *   Make separate call to update CRC, if needed.
+ *
+ *   @param skipped if not NULL, receives count of bytes already correct in EE.
+ *   @return count of bytes actually written.
+ */
+int
+EeValues::writeChangedToEe( unsigned * skipped )
+{
+    EE_TRACE_OP( EE_OP_WRITE );
+
+    unsigned  same = 0;
+    unsigned  written;
+
+    written  = _write_changed( m_start_offset, (const uint8_t *) &this->m_header, sizeof(this->m_header), &same );
+    written += _write_changed( eeOffsetOfUserRecord(), (const uint8_t *) this->userDataPtr(), userRecordSize(), &same );
+
+    EE_TRACE_EVENT( EE_EV_WRITE, m_start_offset, written, same );
+    _note_written();
+
+    if( skipped )
+        *skipped = same;
+
+    return( written );
+}   /* end EeValues::writeChangedToEe() */
+
+
+/***
+ *   Copy 'count' bytes from RAM 'src' to EE 'ee_dst', skipping bytes
+ *   that already hold the wanted value.  EEMEM is byte-wide on AVR, so
+ *   comparing a byte at a time costs the same as comparing wider words.
+ *
+ *   @param skipped incremented by number of bytes NOT written.
+ *   @return number of bytes written.
+ */
+/* static */ unsigned
+EeValues::_write_changed( eeoffset_t ee_dst, const uint8_t * src, unsigned count, unsigned * skipped )
+{
+    unsigned  written = 0;
+
+    for( ; count > 0 ; --count, ++ee_dst, ++src )
+    {
+        if( EeStorage::readByte( ee_dst ) == *src )
+        {
+            ++*skipped;
+            continue;
+        }
+
+        EeStorage::writeByte( ee_dst, *src );
+        ++written;
+    }
+
+    return( written );
+}
+
+/***
+ *   Record now stored at m_start_offset: point its superblock entry here.
+ *   An entry that is already right costs reads only.
+ */
+void
+EeValues::_note_written(void)
+{
+#if EEVALUES_CONF_SUPERBLOCK
+    EeSuperblock::update( ident(), m_start_offset, m_header.m_full_size );
+#endif
+}
+
 /* ------------------------------------------------------------------- */
 
 /***
@@ -273,22 +425,13 @@ void
 EeValues::updateCrc8()
 {
     //  Compute CRC for our overhead, then client's portion of the record.
-    uint8_t   crc = Crc8Block( _EEVALUES_CRC_SEED,
-                                (const uint8_t *) &this->m_header + sizeof(m_header.m_crc8),
-                                sizeof(this->m_header) - sizeof(m_header.m_crc8) );
+    eecrc_t   crc = CRC_BLOCK( EeCrc::seed(),
+                                (const uint8_t *) &this->m_header + sizeof(m_header.m_crc),
+                                sizeof(this->m_header) - sizeof(m_header.m_crc) );
 
-    crc = Crc8Block( crc, (const uint8_t *) userDataPtr(), userRecordSize() );
+    crc = CRC_BLOCK( crc, (const uint8_t *) userDataPtr(), userRecordSize() );
 
     setCrc8( crc );
-
-#if EEVALUES_DEBUG
-    Serial.print( "updateCrc8() over " );
-    Serial.print( totalSize() );
-    Serial.print( " bytes, CRC=0x" );
-    printHexWidth( Serial, this->m_header.m_crc8, 2 );
-    Serial.println();
-#endif
-
 }   /* end EeValues::updateCrc8() */
 
 
@@ -296,28 +439,101 @@ EeValues::updateCrc8()
 void
 EeValues::eraseEeHeader()
 {
-#if EEVALUES_DEBUG
-    Serial.println( "eraseEeHeader()" );
+    EE_TRACE_OP( EE_OP_ERASE );
+
+#if EEVALUES_CONF_SUPERBLOCK
+    EeSuperblock::remove( ident(), m_start_offset );
 #endif
+
     const uint8_t  fill_value = 0xFF;
-    for( int off = sizeof(this->m_header) ; --off >= 0 ; )
-    {
-        eeprom_write_byte( (uint8_t *) (off + m_start_offset), fill_value );
-    }
+    eraseEe( m_start_offset, sizeof(this->m_header), fill_value );
 }
 
 
 void
 EeValues::eraseEeUserData( uint8_t fill_value )
 {
-#if EEVALUES_DEBUG
-    Serial.println( "eraseEeUserData()" );
+    eraseEe( eeOffsetOfUserRecord(), userRecordSize(), fill_value );
+}   /* end EeValues::eraseUserData() */
+
+
+/***
+ *   Tombstone: flip the first byte of the stored ident.  The ident no
+ *   longer matches, so scans skip the record without a CRC check, and
+ *   since the CRC covers the ident the record can't pass as another
+ *   one either.  One byte written, against totalSize() for an erase.
+ *   A torn write leaves the byte old ( record still valid, call again ),
+ *   or anything else, which equally kills it.
+ *
+ *   @return 1 if the tombstone was written, 0 if our ident isn't there.
+ */
+int
+EeValues::invalidate(void)
+{
+    EE_TRACE_OP( EE_OP_ERASE );
+
+    const eeoffset_t  off = m_start_offset + offsetof(EeHeader, m_ident);
+    const uint8_t     have = EeStorage::readByte( off );
+
+    if( have != (uint8_t) ident() )
+        return( 0 );
+
+#if EEVALUES_CONF_SUPERBLOCK
+    EeSuperblock::remove( ident(), m_start_offset );
 #endif
-    for( int off = userRecordSize() ; --off >= 0 ; )
+
+    EeStorage::writeByte( off, (uint8_t) ~have );
+    EE_TRACE_EVENT( EE_EV_ERASE, off, 1, (uint8_t) ~have );
+    return( 1 );
+}   /* end EeValues::invalidate() */
+
+
+/***
+ *   Fill, skipping bytes already at 'fill_value'.  EEMEM is read in small
+ *   blocks and each run of differing bytes goes out as one fill(), so a
+ *   paged part still gets its bursts.  Erasing a mostly blank part costs
+ *   reads, not 3.3 ms per byte.
+ *
+ *   @return number of bytes written.
+ */
+/* static */ unsigned long
+EeValues::eraseEe( eeoffset_t ee_offset, unsigned long count, uint8_t fill_value )
+{
+    EE_TRACE_OP( EE_OP_ERASE );
+
+    unsigned long  written = 0;
+    uint8_t        chunk[16];
+
+    while( count > 0 )
     {
-        eeprom_write_byte( (uint8_t *) (off + m_start_offset), fill_value );
+        const unsigned  n = count < sizeof(chunk) ? (unsigned) count : sizeof(chunk);
+
+        EeStorage::readBlock( chunk, ee_offset, n );
+
+        for( unsigned  i = 0 ; i < n ; )
+        {
+            if( chunk[i] == fill_value )
+            {
+                ++i;
+                continue;
+            }
+
+            unsigned  run = 1;
+            while( i + run < n && chunk[i + run] != fill_value )
+                ++run;
+
+            EeStorage::fill( ee_offset + i, fill_value, run );
+            EE_TRACE_EVENT( EE_EV_ERASE, ee_offset + i, run, fill_value );
+            written += run;
+            i += run;
+        }
+
+        ee_offset += n;
+        count -= n;
     }
-}   /* end EeValues::eraseUserData() */
+
+    return( written );
+}   /* end EeValues::eraseEe() */
 
 
  //  Erase our header and "user data portion".
@@ -343,121 +559,113 @@ boolean
 EeValues::findHeader()
 {
 
-    if( _find_ident() >= 0 )
-        return true;
-
-    return( false );
+    return( _find_ident() );
 }   /* end EeValues::TryRead() */
 
-int
-EeValues::_find_ident()
+
+boolean
+EeValues::findHeader( const EeDirectory & dir )
+{
+    const EeDirEntry *  ent = dir.lookup( ident() );
+
+    if( ent == NULL )
+    {
+        m_start_offset = 0;
+        return( false );
+    }
+
+    m_header.m_full_size = ent->m_full_size;
+    m_start_offset = ent->m_offset;
+    return( true );
+}   /* end EeValues::findHeader() */
+
+
+boolean
+EeValues::_find_ident( boolean stored_size )
 {
-    register uint8_t  match0;
+    uint8_t  match0;
     uint8_t  match1;
     uint8_t  match2;
     uint8_t  match3;
-    FourBytes  buff;
 
     {
-        const FourBytes * p = (const FourBytes *) & this->m_header.m_ident;
-        match0 = p->byte.byte0;
-        match1 = p->byte.byte1;
-        match2 = p->byte.byte2;
-        match3 = p->byte.byte3;
+        FourBytes  id;
+        id.dword = this->m_header.m_ident;      // copy, header is packed
+        match0 = id.byte.byte0;
+        match1 = id.byte.byte1;
+        match2 = id.byte.byte2;
+        match3 = id.byte.byte3;
     }
 
-#if EEVALUES_DEBUG
-    {
-        Serial.print("Looking for \"" );
+    EE_TRACE_OP( EE_OP_FIND );
+    EE_TRACE_EVENT( EE_EV_SCAN_BEGIN, eeOffsetOfHeader(), 0, ident() );
 
-        Serial.print( (char) (this->m_header.m_ident) );
-        Serial.print( (char) (this->m_header.m_ident >> 8) );
-        Serial.print( (char) (this->m_header.m_ident >> 16) );
-        Serial.print( (char) (this->m_header.m_ident >> 24) );
+#if EEVALUES_CONF_SUPERBLOCK
+    {
+        //  Superblock says where ; still check the record is really there.
+        EeSuperblock::Entry  ent;
 
-        Serial.println("\"");
+        if( EeSuperblock::lookup( ident(), &ent ) &&
+            EeStorage::readDword( ent.m_offset + offsetof(EeHeader, m_ident) ) == ident() &&
+            _is_crc_valid( ent.m_offset, stored_size ? ent.m_full_size : totalSize() ) )
+        {
+            m_header.m_full_size = ent.m_full_size;
+            m_start_offset = ent.m_offset;
+            EE_TRACE_EVENT( EE_EV_SCAN_END, m_start_offset, 1, 0 );
+            return( true );
+        }
     }
 #endif
 
-    const int  last_ee = E2END - sizeof(EeHeader) + offsetof(EeHeader, m_ident);
+    //  One past the last offset an ident can start at and still leave room
+    //  for its whole header.
+    const unsigned long  ee_size = EeStorage::size();
+    const unsigned long  end_ident = ee_size < sizeof(EeHeader) ? 0 :
+                                ee_size - sizeof(EeHeader) + offsetof(EeHeader, m_ident) + 1;
 
     //  Loop goes looking for a matching IDENT.  However, check logic is based from start
-    //  of EeHeader structure.
-    for( uint16_t ident_offset = eeOffsetOfHeader() + offsetof(EeHeader, m_ident) ; ident_offset <= last_ee ; ident_offset++ )
+    //  of EeHeader structure.  EEMEM is read a window at a time, plus the
+    //  3 bytes an ident starting at the window's last byte needs, so the
+    //  scan is one pass of block reads, not a read per offset.
+    uint8_t  window[16 + sizeof(EeIdent) - 1];
+
+    for( unsigned long  pos = (unsigned long) eeOffsetOfHeader() + offsetof(EeHeader, m_ident) ; pos < end_ident ; )
     {
-        if( match0 != eeprom_read_byte( (const uint8_t *) ident_offset ) )
-            continue;
+        const unsigned  n = end_ident - pos < 16 ? (unsigned) (end_ident - pos) : 16;
 
-        buff.dword = eeprom_read_dword( (const uint32_t *) ident_offset );
+        EeStorage::readBlock( window, (eeoffset_t) pos, n + sizeof(EeIdent) - 1 );
 
-        if( (buff.byte.byte0 == match0) &&
-            (buff.byte.byte1 == match1) &&
-            (buff.byte.byte2 == match2) &&
-            (buff.byte.byte3 == match3) )
+        for( unsigned  i = 0 ; i < n ; ++i )
         {
-            const uint16_t  base_offset = (uint16_t) (ident_offset - offsetof(EeHeader, m_ident));
-
-#if EEVALUES_DEBUG
-            Serial.print( " .. found Ident-4Code match at EE $" );
-            Serial.println( base_offset, HEX );
-#endif
-            // Found a matching IDENT.
+            if( (window[i] != match0) ||
+                (window[i + 1] != match1) ||
+                (window[i + 2] != match2) ||
+                (window[i + 3] != match3) )
+                continue;
 
-            // Now check if the EE-CRC is valid by recomputing it and checking for a match....
-            match0 = eeprom_read_byte( (const uint8_t *) (base_offset + offsetof(EeHeader, m_crc8) ) );
+            const eeoffset_t  base_offset = (eeoffset_t) (pos + i - offsetof(EeHeader, m_ident));
 
-            //  Remember to skip EE CRC.  We'll compare it afterwards.
-            uint16_t  off = base_offset + sizeof(m_header.m_crc8);
-            uint8_t   siz = totalSize() - sizeof(m_header.m_crc8);
-            uint8_t   crc = _EEVALUES_CRC_SEED;
+            EE_TRACE_EVENT( EE_EV_IDENT_MATCH, base_offset, 0, 0 );
 
-            for( ; siz > 0 ; --siz, ++off )
-            {
-#if EEVALUES_DEBUG_CRC
-                // DEBUG: prefix crc value with EE address.
-                printHexWidth( Serial, off, 3 );
-                Serial.print( ": " );
-#endif
-                crc = Crc8( crc, eeprom_read_byte( (const uint8_t *) off ) );
-            }
-
-#if EEVALUES_DEBUG
-            Serial.print( " .. EE crc=0x" );
-            Serial.print( match0, HEX );
-            Serial.print( " (EE offset=$" );
-
-            const unsigned  offs = base_offset + offsetof(EeHeader, m_crc8);
-            printHexWidth( Serial, offs, 3 );
+            // Now check if the EE-CRC is valid by recomputing it and checking for a match....
+            const unsigned  full_size = stored_size ? _stored_size( base_offset ) : totalSize();
 
-            Serial.print( "), computed CRC=0x" );
-            Serial.print( crc, HEX );
-#endif
-            /* Compare EE read-CRC with EE computed CRC.  Is EE-record valid? */
-            if( match0 == crc )
+            if( _is_crc_valid( base_offset, full_size ) )
             {
-#if EEVALUES_DEBUG
-                Serial.print( " .. found CRC match at $" );
-                printHexWidth( Serial, base_offset, 3 );
-                Serial.println();
-#endif
-                m_header.m_full_size = eeprom_read_byte( (const uint8_t *) (base_offset + offsetof(EeHeader, m_full_size)) );
+                m_header.m_full_size = _stored_size( base_offset );
 
                 m_start_offset = base_offset;
-                return ( base_offset );
-            }
-#if EEVALUES_DEBUG
-            else
-            {
-                Serial.println( " .. no match." );
+                EE_TRACE_EVENT( EE_EV_SCAN_END, base_offset, 1, 0 );
+                return( true );
             }
-#endif
-        }   // if IDENT matches..
+        }   // for each offset in window..
 
+        pos += n;
     }
 
-    //  Something negative means not found.
     m_start_offset = 0;
-    return( -1 );
+    EE_TRACE_EVENT( EE_EV_SCAN_END, 0, 0, 0 );
+    return( false );
 }
 
 #endif  /* EEVALUES_CONF_HUNT_FOR_RECORD */
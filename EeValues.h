@@ -40,7 +40,13 @@
 #define _LIBRARIES_EEVALUES_H
 
 #include <inttypes.h>
+#if defined(ARDUINO)
 #include "Arduino.h"            // for 'boolean' and 'byte'
+#else
+#include <stddef.h>             // host build, see EeStorage.h
+typedef bool     boolean;
+typedef uint8_t  byte;
+#endif
 
 
 /**  Define 1 to hunt/search for RECORD, 0 for client to explicitly state offset. */
@@ -50,7 +56,7 @@
 /* ------------------------------------------------------------------- */
 
 // https://gcc.gnu.org/onlinedocs/gcc/Common-Type-Attributes.html#Common-Type-Attributes
-#ifdef PACKED
+#ifndef PACKED
 #define  PACKED   __attribute__ ((__packed__))
 #endif  /* PACKED */
 
@@ -63,18 +69,73 @@
 
 typedef uint32_t  EeIdent;
 
+//  Receives successive pieces of a user record streamed out of EEMEM.
+typedef void (*EeChunkSink)( void * context, unsigned user_offset, const uint8_t * data, unsigned len );
+
+/**  Define 1 for records over 255 bytes and EE-memory over 64 KB, e.g.
+ *   calibration tables on external FRAM.  Offsets become 32 bits, the
+ *   stored size 16 bits, and the header gets version 3 ; images written
+ *   with the small header are not found by a large build, nor vice versa. */
+#ifndef EEVALUES_CONF_LARGE
+#define EEVALUES_CONF_LARGE     0
+#endif
+
+#if EEVALUES_CONF_LARGE
+typedef uint32_t  eeoffset_t;
+typedef uint16_t  eesize_t;             // full size of one record, header included
+#else
 typedef uint16_t  eeoffset_t;
+typedef uint8_t   eesize_t;
+#endif
+
+//  Largest record EeValues can store, header included.
+#define EEVALUES_MAX_FULL_SIZE  ((eesize_t) -1)
+
+//  Never returned by EeValues itself ; kept for sketches that used them.
+//  Both sit at the very top of eeoffset_t, past any real EE-memory.
 #define  ERR_NO_HEADER  ((eeoffset_t) -1)
 #define  ERR_HEADER_BAD_CRC  ((eeoffset_t) -2)
 
+/**  Define 1 to store a schema version, the layout of the user data, in
+ *   each header ; see setSchema() and EeSchema.h.  Adds a byte to the
+ *   header and so, like EEVALUES_CONF_LARGE, changes the stored format. */
+#ifndef EEVALUES_CONF_SCHEMA
+#define EEVALUES_CONF_SCHEMA    0
+#endif
+
+//  Selects how EE-memory is reached, e.g. on-chip EEMEM or a host file.
+#include "EeStorage.h"
+
+//  Selects CRC engine, and so the type 'eecrc_t' stored in the header.
+#include "EeCrc.h"
+
+//  Header carries a format byte unless the original CRC-8 layout is kept.
+#define _EEVALUES_HDR_FORMAT    (EEVALUES_CONF_CRC != EEVALUES_CRC8_LIB || EEVALUES_CONF_LARGE || EEVALUES_CONF_SCHEMA)
+
+//  Version 3 has a 16-bit 'm_full_size' ; 4 and 5 are 2 and 3 with 'm_schema'.
+#if EEVALUES_CONF_LARGE
+#define _EEVALUES_HDR_VERSION   (3 + 2 * EEVALUES_CONF_SCHEMA)
+#else
+#define _EEVALUES_HDR_VERSION   (2 + 2 * EEVALUES_CONF_SCHEMA)
+#endif
+
+//  Format byte: header version in high nibble, CRC kind in low nibble.
+#define _EEVALUES_FORMAT    ((_EEVALUES_HDR_VERSION << 4) | EEVALUES_CONF_CRC)
+
 
 /* ------------------------------------------------------------------- */
 
+class EeDirectory;
+
 class EeValues
 {
    public :
 #if EEVALUES_CONF_HUNT_FOR_RECORD
      boolean  findHeader();
+
+     //  Resolve 'ident' from a directory built by EeDirectory::scan(),
+     //  without touching EE-memory.  Size is taken from the directory.
+     boolean  findHeader( const EeDirectory & dir );
 #endif
 
      boolean  isHeaderValid(void);
@@ -88,14 +149,32 @@ class EeValues
      //  Erase the EeValues' header in EE memory.
      void eraseEeHeader(void);
 
+     //  Make the record unfindable by changing one byte of its stored ident.
+     //  Returns count of bytes written, 0 if the record isn't there.
+     int  invalidate(void);
+
+     //  Set 'count' bytes of EE-memory from 'ee_offset' to 'fill_value',
+     //  writing only bytes that differ.  All erases above go through here.
+     //  Returns count of bytes written.
+     static unsigned long  eraseEe( eeoffset_t ee_offset, unsigned long count, uint8_t fill_value = 0xff );
+
      EeIdent  ident(void) const { return m_header.m_ident; }
 
+#if EEVALUES_CONF_SCHEMA
+     //  Version of the user data's layout, stored in the header.  Bump it
+     //  when a field is added or moved ; records stored with another
+     //  version fail loadIfValid(), and EeSchema can migrate them.
+     void     setSchema( uint8_t schema ) { m_header.m_schema = schema; }
+     uint8_t  schema(void) const { return m_header.m_schema; }
+#endif
+
      //  User data exists in RAM memory ( not PROGMEM ).
      void     setUserDataPtr( void * user_data ) { m_user_data = user_data; }
      void *   userDataPtr(void) const { return m_user_data; }
 
      // Pass in size of user record ( that doesn't count EeValues header ).
-     void     setUserSize( uint8_t siz ) { m_header.m_full_size = siz + sizeof(EeHeader); }
+     // False, and size left as it was, if header plus 'siz' exceeds EEVALUES_MAX_FULL_SIZE.
+     boolean  setUserSize( unsigned siz );
 
      //  Portion that is client's, i.e. after the EeHeader stored in front of record.
      //  Client's portion of record, not the actual size in ee-memory.
@@ -105,11 +184,15 @@ class EeValues
      unsigned totalSize(void) const { return m_header.m_full_size; }
      
      //  Return total size of EEMEM, i.e. E2END + 1.
-     static unsigned    eeSize() ;
+     static unsigned long  eeSize() ;
 
      //  After calling updateCrc8(), here writes from setUserDataPtr() into EE.
      int        writeToEe( void );
 
+     //  Same as writeToEe(), but only bytes that differ from EEMEM are written.
+     //  Returns count of bytes written ; 'skipped' gets count of bytes left alone.
+     int        writeChangedToEe( unsigned * skipped = NULL );
+
      //  Copies from EE into setUserDataPtr() using size in EE header.
      int        readToUser( void );
 
@@ -118,11 +201,22 @@ class EeValues
      //   of header to current record.
      int        readToUser( eeoffset_t ee_offset, void * user_buffer, size_t ee_count );
 
+     //  isHeaderValid() plus readToUser() in one pass over EEMEM.  Header at
+     //  eeOffsetOfHeader() must match ident and size ( and schema ).  If CRC is bad, false
+     //  is returned and the user's buffer holds garbage.
+     boolean    loadIfValid( void );
+
+     //  Same, for records bigger than RAM: user data goes to 'sink' in
+     //  pieces of up to 'scratch_size' bytes.  Only when this returns true
+     //  are the pieces known good, so 'sink' should stage, not apply.
+     boolean    loadIfValid( EeChunkSink sink, void * context, uint8_t * scratch, unsigned scratch_size );
+
+     //  Names kept from CRC-8 days ; type follows EEVALUES_CONF_CRC.
      void     updateCrc8();
-     uint8_t  crc8() const   { return m_header.m_crc8; }
-     void     setCrc8( uint8_t crc ) { m_header.m_crc8 = crc; }
+     eecrc_t  crc8() const   { return m_header.m_crc; }
+     void     setCrc8( eecrc_t crc ) { m_header.m_crc = crc; }
 
-     boolean     setEeOffset( eeoffset_t starting ) { m_start_offset = starting; }
+     boolean     setEeOffset( eeoffset_t starting ) { m_start_offset = starting; return true; }
 
      //  Return EE offset of where header was found.
      eeoffset_t  eeOffsetOfHeader(void) const { return m_start_offset; }
@@ -137,14 +231,29 @@ class EeValues
      //  Header is stored in EEPROM ahead of user-bytes.
      //  A copy is here for match / finding the 4 char identification.
      //  CRC IS STORED FIRST, WHEN COMPUTING CHECK, CODE ASSUMES THIS.
-     struct EeHeader {
-        uint8_t        m_crc8;             // valid after call to this->update_crc8()
+     //  Packed so host builds lay it out exactly as AVR does.
+     struct PACKED EeHeader {
+        eecrc_t        m_crc;              // valid after call to this->updateCrc8()
+
+#if _EEVALUES_HDR_FORMAT
+        uint8_t        m_format;           // _EEVALUES_FORMAT
+#endif
+
+#if EEVALUES_CONF_SCHEMA
+        uint8_t        m_schema;           // layout version of user data, setSchema()
+#endif
 
-        uint8_t        m_full_size;        // actual, full size, including EeValues overhead.
+        eesize_t       m_full_size;        // actual, full size, including EeValues overhead.
 
         EeIdent        m_ident;
      } m_header;
 
+   public :
+     //  Bytes of EeValues overhead stored ahead of each user record.
+     enum { HEADER_SIZE = sizeof(EeHeader) };
+
+   protected :
+
      //  Offset to start of header for user's record.
      eeoffset_t     m_start_offset;
 
@@ -152,9 +261,26 @@ class EeValues
      void *         m_user_data;
 
 #if EEVALUES_CONF_HUNT_FOR_RECORD
-     int       _find_ident();
+     //  'stored_size' true validates each candidate over the size stored in
+     //  its own header, for records whose stored size varies ( EeCompressed ).
+     boolean   _find_ident( boolean stored_size = false );
 #endif
 
+     boolean          _load_header( eecrc_t * crc );
+     static eesize_t  _stored_size( eeoffset_t base_offset );
+     void             _note_written(void);
+     static boolean   _is_crc_valid( eeoffset_t base_offset, unsigned full_size );
+     static unsigned  _write_changed( eeoffset_t ee_dst, const uint8_t * src, unsigned count, unsigned * skipped );
+
+     friend class EeDirectory;
+     friend class EeAsyncWriter;
+     friend class EeSuperblock;
+     friend class EeKv;
+     friend class EeFinder;
+     friend class EeDesc;
+     friend class EeSchema;
+     friend class EeBatch;
+
    private :
      // no implementation for these:
      EeValues( const EeValues & );
@@ -4,13 +4,14 @@
 #include <crc8.h>
 
 #include <EeValues.h>
+#include <EeLayout.h>
+#include <EeSchema.h>
 #include <CnUtils.h>
 
 
 /* ------------------------------------------------------------------- */
 
 #define REC_IDENT   MK4CODE('I','D', 'N', 'T')
-#define REC_EE_OFFSET   10
 
 struct MyIdent
 {
@@ -18,10 +19,31 @@ struct MyIdent
     char       SN[ 8 ];
 } flim;
 
+//  Firmware before 'poll_addr' stored just the 8 byte SN ; carry it over.
+static const EeFieldMap   ident_v0_fields[] PROGMEM = { { 0, 1, 8 } };
+static const EeMigration  ident_migrations[] PROGMEM = { { 0, 8, ident_v0_fields, 1 } };
+
+//  Compiler places records from EE offset 10, or just past the superblock
+//  when there is one ; list more types here as they are added.
+#if EEVALUES_CONF_SUPERBLOCK
+#define EE_MAP_BASE     EeSuperblock::END
+#else
+#define EE_MAP_BASE     10
+#endif
+typedef EeLayoutAt< EE_MAP_BASE, 1, MyIdent >  EeMap;
+#define REC_EE_OFFSET   EeMap::offsetOf< MyIdent >()
+
 EeValues    eeMyIdent(REC_IDENT);
 
 /* ------------------------------------------------------------------- */
 
+void set_defaults()
+{
+    flim.poll_addr = 0x41 ;
+    memcpy( flim.SN, "12345678", sizeof(flim.SN) );
+}   /* end set_defaults() */
+
+
 // #undef F
 // #define F(str) str
 
@@ -78,7 +100,14 @@ update_poll_addr()
             flim.poll_addr += 1;
             
             eeMyIdent.updateCrc8();
-            eeMyIdent.writeToEe();
+
+            //  Only 'poll_addr' and CRC change, so just those are written.
+            unsigned  skipped;
+            int  written = eeMyIdent.writeChangedToEe( &skipped );
+            Serial.print( "Wrote " );
+            Serial.print( written );
+            Serial.print( " bytes, skipped " );
+            Serial.println( skipped );
       }
       else
       {
@@ -108,6 +137,10 @@ void setup() {
       Serial.print( "Found it at EE offset $" );
       printHexWidth( Serial, eeMyIdent.eeOffsetOfHeader(), 3 );
       Serial.println();
+#if EEVALUES_CONF_SUPERBLOCK
+      //  findHeader() only reads ; point the superblock at it if it scanned.
+      EeSuperblock::repair( eeMyIdent );
+#endif
   }
   else
   {
@@ -136,23 +169,36 @@ void setup() {
   }
   else
   {
-      Serial.println( F("No record found, creating default one...") );
-      flim.poll_addr = 0x41 ;
-      memcpy( flim.SN, "12345678", sizeof(flim.SN) );
+      //  Defaults for any field an old record lacks.
+      set_defaults();
 
-      eeMyIdent.updateCrc8();
-      eeMyIdent.writeToEe();
-      
-      //  Do a verification cycle, since this is an example sketch!
-      eeMyIdent.setEeOffset( REC_EE_OFFSET );
-      res = eeMyIdent.isHeaderValid();
-      if( res )
+      int  migrated = EeSchema::loadOrMigrate( eeMyIdent, ident_migrations, 1 );
+      if( migrated > 0 )
       {
-          Serial.println( F("Yes, EE block verified!!") );
+          Serial.print( F("Migrated old record, wrote ") );
+          Serial.print( migrated );
+          Serial.println( F(" bytes.") );
       }
       else
       {
-          Serial.println( F("ERROR: EE BLOCK FAILURE VERIFICATION!!") );
+          Serial.println( F("No record found, creating default one...") );
+          set_defaults();               // a failed migration may leave garbage
+
+          eeMyIdent.setEeOffset( REC_EE_OFFSET );
+          eeMyIdent.updateCrc8();
+          eeMyIdent.writeToEe();
+      
+          //  Do a verification cycle, since this is an example sketch!
+          eeMyIdent.setEeOffset( REC_EE_OFFSET );
+          res = eeMyIdent.isHeaderValid();
+          if( res )
+          {
+              Serial.println( F("Yes, EE block verified!!") );
+          }
+          else
+          {
+              Serial.println( F("ERROR: EE BLOCK FAILURE VERIFICATION!!") );
+          }
       }
   }
 
@@ -185,13 +231,12 @@ void loop() {
         {
             case 'E' :
                 {
-                EeValues  erasure( 0 );
-                erasure.setEeOffset( 0 );
-                erasure.setUserSize( erasure.eeSize() - 16 );
-                erasure.eraseWholeRecord();
+                //  Bytes already 0xFF are skipped, so a mostly blank part is quick.
+                unsigned long  written = EeValues::eraseEe( 0, EeValues::eeSize() );
+                Serial.print( "EE erased, wrote " );
+                Serial.print( written );
+                Serial.println( " bytes." );
                 }
-     
-                 Serial.println( "EE erased." );
                  break;
                  
              case 'D' :
@@ -0,0 +1,1151 @@
+/** eebench.cpp ** Host benchmark of EeValues entry points **  Oct 2026 **/
+/*
+ *  Runs every EeValues entry point against the mmap() EEMEM back-end,
+ *  sweeping image size, record count, record size and where the wanted
+ *  record sits.  For each operation it reports host wall time plus the
+ *  EEMEM traffic that the back-end counted: bytes read, bytes written,
+ *  and modelled busy time ( 3.3 ms per byte written on AVR ).
+ *
+ *  Output is one JSON object per line on stdout, so runs from two
+ *  releases can be diffed or loaded into a spreadsheet.
+ *
+ *  Built with SB=n, records sit after an n entry superblock and
+ *  findHeader() is a superblock lookup instead of a scan.
+ *
+ *  Built with TRACE=1, a 'wear' line per commit scheme gives the hottest
+ *  byte's write count and how many commits that byte's endurance allows.
+ *
+ *  Lines with an "ok" field also check the result ; if any is false,
+ *  eebench exits non-zero.
+ *
+ *  usage:  eebench [ image-file ]      default /tmp/eebench.eep
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <EeValues.h>
+#include <EeDirectory.h>
+#include <EeAsyncWriter.h>
+#include <EePagedStorage.h>
+#include <EeRing.h>
+#include <EeCompressed.h>
+#include <EeSuperblock.h>
+#include <EeKv.h>
+#include <EeFinder.h>
+#include <EeDescriptor.h>
+#include <EeSchema.h>
+#include <EeBatch.h>
+
+/* ------------------------------------------------------------------- */
+
+#if EEVALUES_CONF_LARGE
+static const unsigned  image_sizes[]   = { 128, 256, 512, 1024, 2048, 4096, 16384, 65536, 262144 };
+static const unsigned  record_counts[] = { 1, 4, 8 };
+static const unsigned  record_sizes[]  = { 8, 32, 120, 1000, 4000 };
+#define USER_MAX    4096
+#else
+static const unsigned  image_sizes[]   = { 128, 256, 512, 1024, 2048, 4096 };
+static const unsigned  record_counts[] = { 1, 4, 8 };
+static const unsigned  record_sizes[]  = { 8, 32, 120 };
+#define USER_MAX    256
+#endif
+
+enum Position { POS_FIRST, POS_MIDDLE, POS_LAST };
+static const char * const  position_names[] = { "first", "middle", "last" };
+
+//  Records go after the superblock, if built with one.
+#if EEVALUES_CONF_SUPERBLOCK
+#define IMAGE_BASE  ((unsigned) EeSuperblock::END)
+#else
+#define IMAGE_BASE  0u
+#endif
+
+//  Repeat each timed operation, so short ones rise above clock noise.
+#define REPEAT      20
+
+struct Case
+{
+    unsigned    image;
+    unsigned    records;
+    unsigned    rec_size;
+    Position    position;
+
+    unsigned    stride(void) const { return (image - IMAGE_BASE) / records; }
+    eeoffset_t  offsetOf( unsigned i ) const { return IMAGE_BASE + i * stride(); }
+    unsigned    target(void) const
+                    { return position == POS_FIRST ? 0 : position == POS_MIDDLE ? records / 2 : records - 1; }
+};
+
+static const char *  s_path = "/tmp/eebench.eep";
+static boolean       s_failed = false;
+
+#if EEVALUES_CONF_CACHE_LINES
+#define RESET_COUNTERS()    ( EeStorage::resetCounters(), EeStorage::resetCacheCounters() )
+#else
+#define RESET_COUNTERS()    EeStorage::resetCounters()
+#endif
+
+static uint8_t       s_user[USER_MAX];
+
+/* ------------------------------------------------------------------- */
+
+static unsigned long long
+now_ns(void)
+{
+    struct timespec  ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+//  JSON value of an "ok" field ; a false one fails the run.
+static const char *
+ok_json( boolean ok )
+{
+    if( ! ok )
+        s_failed = true;
+    return( ok ? "true" : "false" );
+}
+
+
+static EeIdent
+ident_of( unsigned index )
+{
+    return MK4CODE( 'B', 'N', 'C', 'A' + index );
+}
+
+
+/***
+ *   One line of output.  Counters are what the back-end saw over all
+ *   'repeat' calls, so divide them back down to one call.
+ */
+static void
+report( const Case & c, const char * op, unsigned long long ns, unsigned repeat )
+{
+    printf( "{\"op\":\"%s\",\"image\":%u,\"records\":%u,\"rec_size\":%u,\"position\":\"%s\","
+            "\"ns\":%llu,\"reads\":%lu,\"writes\":%lu,\"busy_ms\":%.1f",
+            op, c.image, c.records, c.rec_size, position_names[c.position],
+            ns / repeat,
+            EeStorage::bytesRead() / repeat,
+            EeStorage::bytesWritten() / repeat,
+            EeStorage::busyMicros() / 1000.0 / repeat );
+#if EEVALUES_CONF_CACHE_LINES
+    //  'reads' above are misses filling lines ; hits never reach EEMEM.
+    printf( ",\"cache_hits\":%lu,\"cache_misses\":%lu",
+            EeStorage::hits() / repeat, EeStorage::misses() / repeat );
+#endif
+    printf( "}\n" );
+}
+
+
+/***
+ *   Blank image, then 'records' records spread evenly across it.
+ */
+static boolean
+build_image( const Case & c )
+{
+    if( ! EeStorage::open( s_path, c.image ) )
+        return( false );
+
+    memset( EeStorage::image(), 0xFF, c.image );
+#if EEVALUES_CONF_CACHE_LINES
+    EeStorage::invalidate();
+#endif
+
+    for( unsigned  i = 0 ; i < c.records ; ++i )
+    {
+        EeValues  rec( ident_of( i ) );
+
+        memset( s_user, 0x30 + i, c.rec_size );
+        rec.setUserDataPtr( s_user );
+        rec.setUserSize( c.rec_size );
+        rec.setEeOffset( c.offsetOf( i ) );
+        rec.updateCrc8();
+        rec.writeToEe();
+    }
+
+    return( true );
+}
+
+
+static void
+run_case( const Case & c )
+{
+    unsigned long long  t0;
+    const EeIdent       want = ident_of( c.target() );
+    const eeoffset_t    at = c.offsetOf( c.target() );
+
+    if( ! build_image( c ) )
+    {
+        fprintf( stderr, "eebench: can't map %s\n", s_path );
+        exit( 1 );
+    }
+
+    EeValues  rec( want );
+    rec.setUserDataPtr( s_user );
+    rec.setUserSize( c.rec_size );
+
+    RESET_COUNTERS();
+    t0 = now_ns();
+    for( unsigned  n = 0 ; n < REPEAT ; ++n )
+    {
+        rec.setEeOffset( 0 );
+        rec.findHeader();
+    }
+    report( c, "findHeader", now_ns() - t0, REPEAT );
+
+    RESET_COUNTERS();
+    t0 = now_ns();
+    for( unsigned  n = 0 ; n < REPEAT ; ++n )
+    {
+        rec.setEeOffset( at );
+        rec.isHeaderValid();
+    }
+    report( c, "isHeaderValid", now_ns() - t0, REPEAT );
+
+    RESET_COUNTERS();
+    t0 = now_ns();
+    for( unsigned  n = 0 ; n < REPEAT ; ++n )
+    {
+        EeDirEntry   table[16];
+        EeDirectory  dir( table, 16 );
+        dir.scan();
+    }
+    report( c, "EeDirectory::scan", now_ns() - t0, REPEAT );
+
+    RESET_COUNTERS();
+    t0 = now_ns();
+    for( unsigned  n = 0 ; n < REPEAT ; ++n )
+        rec.readToUser();
+    report( c, "readToUser", now_ns() - t0, REPEAT );
+
+    //  Boot path, compare with isHeaderValid + readToUser above.
+    RESET_COUNTERS();
+    t0 = now_ns();
+    for( unsigned  n = 0 ; n < REPEAT ; ++n )
+        rec.loadIfValid();
+    report( c, "loadIfValid", now_ns() - t0, REPEAT );
+
+    RESET_COUNTERS();
+    t0 = now_ns();
+    for( unsigned  n = 0 ; n < REPEAT ; ++n )
+    {
+        rec.updateCrc8();
+        rec.writeToEe();
+    }
+    report( c, "writeToEe", now_ns() - t0, REPEAT );
+
+    //  Typical update: one field of the record changes between commits.
+    RESET_COUNTERS();
+    t0 = now_ns();
+    for( unsigned  n = 0 ; n < REPEAT ; ++n )
+    {
+        s_user[0] += 1;
+        rec.updateCrc8();
+        rec.writeChangedToEe();
+    }
+    report( c, "writeChangedToEe", now_ns() - t0, REPEAT );
+
+    //  Async commit of a whole new record: caller latency is one begin()
+    //  plus the worst single poll(), not the total.  The back-end models
+    //  each write cycle, so most polls find EEMEM busy and must return at
+    //  once.  No poll may write more than one byte or read more than
+    //  EEVALUES_ASYNC_SKIP_MAX, bar the last, which with a superblock may
+    //  also update the record's entry.  Check it validates.
+    {
+        uint8_t        snapshot[USER_MAX + 44];
+        EeAsyncWriter  writer( snapshot, sizeof(snapshot) );
+        unsigned long long  worst = 0;
+        unsigned       polls = 0;
+        unsigned long  worst_writes = 0;
+        unsigned long  worst_reads = 0;
+        unsigned long  last_writes = 0;
+
+        memset( s_user, 0xA5, c.rec_size );
+        rec.setEeOffset( at );
+        rec.updateCrc8();
+
+        RESET_COUNTERS();
+        t0 = now_ns();
+        writer.begin( rec );
+        const unsigned long long  begin_ns = now_ns() - t0;
+
+        while( writer.busy() )
+        {
+            const unsigned long  before = EeStorage::bytesWritten();
+            const unsigned long  before_reads = EeStorage::bytesRead();
+
+            t0 = now_ns();
+            writer.poll();
+            const unsigned long long  ns = now_ns() - t0;
+            const unsigned long  writes = EeStorage::bytesWritten() - before;
+            const unsigned long  reads = EeStorage::bytesRead() - before_reads;
+
+            if( ns > worst )
+                worst = ns;
+            if( writer.done() )
+                last_writes = writes;
+            else
+            {
+                if( writes > worst_writes )
+                    worst_writes = writes;
+                if( reads > worst_reads )
+                    worst_reads = reads;
+            }
+            ++polls;
+        }
+
+        const unsigned long  busy_polls = EeStorage::busyPolls();
+        const unsigned long  writes = EeStorage::bytesWritten();
+
+#if EEVALUES_CONF_CACHE_LINES
+        //  A cache miss reads its whole line.
+        const unsigned long  max_reads = EEVALUES_ASYNC_SKIP_MAX + 2 * EEVALUES_CONF_CACHE_LINE_SIZE;
+#else
+        const unsigned long  max_reads = EEVALUES_ASYNC_SKIP_MAX;
+#endif
+
+        memset( s_user, 0, c.rec_size );
+        const boolean  ok = rec.isHeaderValid() && (rec.readToUser(), s_user[c.rec_size - 1] == 0xA5) &&
+                            worst_writes <= 1 && worst_reads <= max_reads &&
+                            ( EEVALUES_CONF_SUPERBLOCK || last_writes <= 1 ) &&
+                            ( writes < 2 || busy_polls > 0 );
+
+        printf( "{\"op\":\"EeAsyncWriter\",\"image\":%u,\"records\":%u,\"rec_size\":%u,\"position\":\"%s\","
+                "\"begin_ns\":%llu,\"max_poll_ns\":%llu,\"polls\":%u,\"busy_polls\":%lu,\"max_poll_writes\":%lu,"
+                "\"max_poll_reads\":%lu,\"last_poll_writes\":%lu,\"writes\":%lu,\"ok\":%s}\n",
+                c.image, c.records, c.rec_size, position_names[c.position],
+                begin_ns, worst, polls, busy_polls, worst_writes, worst_reads, last_writes, writes, ok_json( ok ) );
+    }
+
+    //  Tombstone a freshly written record: one byte, however big it is.
+    rec.writeToEe();
+    RESET_COUNTERS();
+    t0 = now_ns();
+    rec.invalidate();
+    report( c, "invalidate", now_ns() - t0, 1 );
+
+    //  Last, it wrecks the image.
+    RESET_COUNTERS();
+    t0 = now_ns();
+    for( unsigned  n = 0 ; n < REPEAT ; ++n )
+        rec.eraseWholeRecord();
+    report( c, "eraseWholeRecord", now_ns() - t0, REPEAT );
+}
+
+
+/***
+ *   Validation-path cost of each CRC engine, per byte, next to the size
+ *   of the PROGMEM table it needs.  Host ns are only a relative guide ;
+ *   AVR cycle counts have to come from the target.
+ */
+template< uint8_t KIND >
+static void
+run_crc( const char * name, unsigned table_bytes )
+{
+    static uint8_t  buff[4096];
+    typename EeCrcEngine< KIND >::value_t  crc = EeCrcEngine< KIND >::seed();
+
+    for( unsigned  i = 0 ; i < sizeof(buff) ; ++i )
+        buff[i] = (uint8_t) (i * 7);
+
+    const unsigned  rounds = 200;
+    const unsigned long long  t0 = now_ns();
+    for( unsigned  n = 0 ; n < rounds ; ++n )
+        crc = EeCrcEngine< KIND >::block( crc, buff, sizeof(buff) );
+    const unsigned long long  ns = now_ns() - t0;
+
+    printf( "{\"op\":\"crc\",\"engine\":\"%s\",\"table_bytes\":%u,\"ns_per_byte\":%.3f,\"crc\":%u}\n",
+            name, table_bytes, (double) ns / rounds / sizeof(buff), (unsigned) crc );
+}
+
+
+/***
+ *   External paged EEPROM ( 24LC256-like, 64 byte page, 5 ms cycle ):
+ *   page-burst writes against byte-at-a-time, for one record written
+ *   at an offset that is not page aligned.  Busy time is the device's
+ *   write cycles, which dominate wall time on the real part.  The model
+ *   reports busy until each cycle is over, so 'busy_polls' counts the
+ *   ACK polls spent waiting, and the wait must cover every cycle but
+ *   the last, which runs on behind the caller until the read back.
+ */
+static void
+run_paged(void)
+{
+    typedef EeSimPagedBus< 64, 32768UL >  Bus;
+    typedef EePagedStorage< Bus >         Paged;
+
+    static const unsigned  sizes[] = { 16, 64, 128, 256, 1024 };
+    static uint8_t         buff[1024];
+
+    for( unsigned  i = 0 ; i < sizeof(buff) ; ++i )
+        buff[i] = (uint8_t) i;
+
+    for( unsigned  i = 0 ; i < sizeof(sizes) / sizeof(sizes[0]) ; ++i )
+    {
+        const unsigned    n = sizes[i];
+        const eeoffset_t  at = 10;
+
+        Bus::erase();
+        Paged::writeBlock( at, buff, n );
+        const unsigned long  burst_cycles = Bus::s_cycles;
+        const unsigned long  burst_us = Bus::s_busy_us;
+        const unsigned long  burst_polls = Bus::s_busy_polls;
+        const boolean        ok = memcmp( Bus::s_mem + at, buff, n ) == 0 &&
+                                  burst_polls * Bus::POLL >= ( burst_cycles - 1 ) * (unsigned long) Bus::CYCLE &&
+                                  ! Bus::isReady();
+
+        Bus::erase();
+        for( unsigned  k = 0 ; k < n ; ++k )
+            Paged::writeByte( at + k, buff[k] );
+        const unsigned long  byte_us = Bus::s_busy_us;
+
+        Bus::reset();
+        Paged::readBlock( buff, at, n );
+        const unsigned long  read_transactions = Bus::s_transactions;
+
+        //  Part seen ready once since the last write: no more polling.
+        Bus::reset();
+        Paged::readBlock( buff, at, n );
+        const unsigned long  idle_read_polls = Bus::s_polls;
+
+        printf( "{\"op\":\"paged_write\",\"page\":%u,\"bytes\":%u,\"burst_cycles\":%lu,\"burst_ms\":%.1f,"
+                "\"busy_polls\":%lu,\"bytewise_ms\":%.1f,\"speedup\":%.1f,\"read_transactions\":%lu,"
+                "\"idle_read_polls\":%lu,\"ok\":%s}\n",
+                (unsigned) Bus::PAGE, n, burst_cycles, burst_us / 1000.0,
+                burst_polls, byte_us / 1000.0, (double) byte_us / burst_us, read_transactions,
+                idle_read_polls, ok_json( ok && idle_read_polls == 0 ) );
+    }
+}
+
+
+/***
+ *   Run-length coding on three kinds of record: a pin map that is mostly
+ *   0xFF "unused", a calibration table of small values among zeros, and
+ *   random bytes as the worst case.  Reports ratio, RAM encode / decode
+ *   cost, and EEMEM bytes of a first write and of a one-byte change,
+ *   EeCompressed against a plain EeValues record.
+ */
+static void
+run_compress(void)
+{
+    static const unsigned      sizes[] = { 32, 64, 128, 240 };
+    static const char * const  kinds[] = { "pin_map", "calibration", "random" };
+
+    static uint8_t  raw[240];
+    static uint8_t  coded[256];
+    static uint8_t  back[240];
+
+    for( unsigned  k = 0 ; k < sizeof(kinds) / sizeof(kinds[0]) ; ++k )
+      for( unsigned  i = 0 ; i < sizeof(sizes) / sizeof(sizes[0]) ; ++i )
+      {
+          const unsigned  n = sizes[i];
+
+          srand( 1 );
+          for( unsigned  j = 0 ; j < n ; ++j )
+          {
+              if( k == 0 )
+                  raw[j] = (j % 16 < 3) ? (uint8_t) (j / 16) : 0xFF;
+              else if( k == 1 )
+                  raw[j] = (j % 8 == 0) ? (uint8_t) rand() : 0;
+              else
+                  raw[j] = (uint8_t) rand();
+          }
+
+          const unsigned  rounds = 2000;
+          unsigned        m = 0;
+
+          unsigned long long  t0 = now_ns();
+          for( unsigned  r = 0 ; r < rounds ; ++r )
+              m = EeCompressed::rleEncode( raw, n, coded );
+          const unsigned long long  enc_ns = now_ns() - t0;
+
+          int  d = 0;
+          t0 = now_ns();
+          for( unsigned  r = 0 ; r < rounds ; ++r )
+              d = EeCompressed::rleDecode( coded, m, back, n );
+          const unsigned long long  dec_ns = now_ns() - t0;
+
+          const boolean  ok = d == (int) n && memcmp( raw, back, n ) == 0;
+
+          //  Through EEMEM: first write, then one byte changed.
+          memset( EeStorage::image(), 0xFF, EeStorage::size() );
+#if EEVALUES_CONF_CACHE_LINES
+          EeStorage::invalidate();
+#endif
+          EeCompressed  packed( MK4CODE('P','A','C','K') );
+          packed.setUserDataPtr( raw );
+          packed.setUserSize( n );
+          packed.updateCrc8();
+          const int  packed_first = packed.writeChangedToEe();
+          raw[n / 2] ^= 0x01;
+          packed.updateCrc8();
+          const int  packed_change = packed.writeChangedToEe();
+          raw[n / 2] ^= 0x01;
+
+          memset( EeStorage::image(), 0xFF, EeStorage::size() );
+#if EEVALUES_CONF_CACHE_LINES
+          EeStorage::invalidate();
+#endif
+          EeValues  plain( MK4CODE('P','L','A','N') );
+          plain.setUserDataPtr( raw );
+          plain.setUserSize( n );
+          plain.updateCrc8();
+          const int  plain_first = plain.writeChangedToEe();
+          raw[n / 2] ^= 0x01;
+          plain.updateCrc8();
+          const int  plain_change = plain.writeChangedToEe();
+
+          printf( "{\"op\":\"compress\",\"data\":\"%s\",\"bytes\":%u,\"coded\":%u,\"ratio\":%.2f,"
+                  "\"codec\":%u,\"stored\":%u,\"encode_ns_per_byte\":%.2f,\"decode_ns_per_byte\":%.2f,"
+                  "\"first_write\":%d,\"plain_first_write\":%d,\"change_write\":%d,\"plain_change_write\":%d,"
+                  "\"ok\":%s}\n",
+                  kinds[k], n, m, (double) m / n, (unsigned) packed.codec(), packed.totalSize(),
+                  (double) enc_ns / rounds / n, (double) dec_ns / rounds / n,
+                  packed_first, plain_first, packed_change, plain_change, ok_json( ok ) );
+      }
+}
+
+
+#if EEVALUES_CONF_TRACE && EEVALUES_CONF_TRACE_WEAR
+
+/***
+ *   A 16 byte record whose first word counts commits, committed 1000
+ *   times in place and through an EeRing of 4 slots.  From the hottest
+ *   bucket's write count, project commits until it reaches the 100000
+ *   cycle endurance of AVR EEMEM.
+ */
+static void
+run_wear(void)
+{
+    struct Counter { uint16_t n; uint8_t rest[14]; };
+    static const unsigned  commits = 1000;
+    static const unsigned long  endurance = 100000UL;
+
+    Counter  rec;
+    memset( &rec, 0, sizeof(rec) );
+
+    for( int  scheme = 0 ; scheme < 2 ; ++scheme )
+    {
+        memset( EeStorage::image(), 0xFF, EeStorage::size() );
+#if EEVALUES_CONF_CACHE_LINES
+        EeStorage::invalidate();
+#endif
+        EeTrace::resetWear();
+
+        EeValues  plain( MK4CODE('W','E','A','R') );
+        EeRing    ring( MK4CODE('W','E','A','R'), 0, 4 );
+
+        plain.setUserDataPtr( &rec );
+        plain.setUserSize( sizeof(rec) );
+        ring.setUserDataPtr( &rec );
+        ring.setUserSize( sizeof(rec) );
+
+        for( rec.n = 0 ; rec.n < commits ; ++rec.n )
+        {
+            if( scheme == 0 )
+            {
+                plain.updateCrc8();
+                plain.writeChangedToEe();
+            }
+            else
+            {
+                ring.commit();
+            }
+        }
+
+        eeoffset_t      at;
+        const uint32_t  hot = EeTrace::hottest( &at );
+
+        printf( "{\"op\":\"wear\",\"scheme\":\"%s\",\"bucket\":%u,\"commits\":%u,\"hottest\":%u,"
+                "\"hottest_at\":%u,\"commits_to_endurance\":%lu}\n",
+                scheme == 0 ? "in_place" : "ring4", (unsigned) EEVALUES_CONF_TRACE_WEAR, commits,
+                (unsigned) hot, (unsigned) at, hot ? (unsigned long) ((double) endurance * commits / hot) : 0UL );
+    }
+}
+
+#endif
+
+
+/***
+ *   Settings churn: 8 keys of 8 bytes, 2000 updates to random keys, each
+ *   changing a counter in the value.  8 in-place records, 64 bytes apart
+ *   and updated with writeChangedToEe(), against EeKv logs of 512 and 1024
+ *   bytes.  Reports ns per put and get, write amplification ( EEMEM bytes
+ *   written per value byte put ), the hottest byte's write cycles, and
+ *   compactions.
+ */
+static void
+run_kv(void)
+{
+    static const unsigned  image = IMAGE_BASE + 1024;
+    static const unsigned  regions[] = { 8 * 64, 512, 1024 };
+    static const unsigned  keys = 8;
+    static const unsigned  updates = 2000;
+    struct Value { uint32_t count; uint8_t rest[4]; };
+
+    for( int  scheme = 0 ; scheme < 3 ; ++scheme )
+    {
+        if( ! EeStorage::open( s_path, image ) )
+            return;
+
+        memset( EeStorage::image(), 0xFF, image );
+#if EEVALUES_CONF_CACHE_LINES
+        EeStorage::invalidate();
+#endif
+
+        EeDirEntry  index[keys];
+        EeKv        kv( IMAGE_BASE, regions[scheme], index, keys );
+        Value       values[keys];
+
+        memset( values, 0, sizeof(values) );
+        if( scheme > 0 )
+            kv.begin();
+
+        RESET_COUNTERS();
+        srand( 1 );
+        unsigned long long  put_ns = 0;
+
+        for( unsigned  n = 0 ; n < updates ; ++n )
+        {
+            const unsigned  k = rand() % keys;
+
+            values[k].count += 1;
+
+            const unsigned long long  t0 = now_ns();
+            if( scheme == 0 )
+            {
+                EeValues  rec( MK4CODE('S','E','T','0' + k) );
+
+                rec.setUserDataPtr( &values[k] );
+                rec.setUserSize( sizeof(values[k]) );
+                rec.setEeOffset( IMAGE_BASE + k * 64 );
+                rec.updateCrc8();
+                rec.writeChangedToEe();
+            }
+            else
+            {
+                kv.put( MK4CODE('S','E','T','0' + k), &values[k], sizeof(values[k]) );
+            }
+            put_ns += now_ns() - t0;
+        }
+
+        const unsigned long  written = EeStorage::bytesWritten();
+
+        //  Read every key back and check it.
+        boolean  ok = true;
+        unsigned long long  t0 = now_ns();
+        for( unsigned  k = 0 ; k < keys ; ++k )
+        {
+            Value  got;
+
+            if( scheme == 0 )
+            {
+                EeValues  rec( MK4CODE('S','E','T','0' + k) );
+
+                rec.setUserDataPtr( &got );
+                rec.setUserSize( sizeof(got) );
+                rec.setEeOffset( IMAGE_BASE + k * 64 );
+                ok = ok && rec.loadIfValid();
+            }
+            else
+            {
+                ok = ok && kv.get( MK4CODE('S','E','T','0' + k), &got, sizeof(got) ) == (int) sizeof(got);
+            }
+            ok = ok && memcmp( &got, &values[k], sizeof(got) ) == 0;
+        }
+        const unsigned long long  get_ns = now_ns() - t0;
+
+        unsigned long  hottest = 0;
+        for( unsigned  i = 0 ; i < image ; ++i )
+            if( EeStorage::writeCycles( i ) > hottest )
+                hottest = EeStorage::writeCycles( i );
+
+        printf( "{\"op\":\"kv\",\"scheme\":\"%s\",\"region\":%u,\"keys\":%u,\"updates\":%u,\"put_ns\":%llu,\"get_ns\":%llu,"
+                "\"writes\":%lu,\"write_amp\":%.2f,\"hottest\":%lu,\"compactions\":%u,\"ok\":%s}\n",
+                scheme == 0 ? "in_place" : "eekv", regions[scheme], keys, updates, put_ns / updates, get_ns / keys,
+                written, (double) written / (updates * sizeof(Value)), hottest,
+                scheme == 0 ? 0u : (unsigned) kv.generation(), ok_json( ok ) );
+    }
+}
+
+
+/***
+ *   Bounded boot latency: a 4 KB image holding 8 stale copies of a 120
+ *   byte record ( same ident, bad CRC ) ahead of the real one.  Blocking
+ *   findHeader() against EeFinder::step() at several budgets.  For the
+ *   stepped hunt, the most EEMEM bytes and host ns any one step took ;
+ *   the slowest step is the best of REPEAT runs, to keep clock noise out.
+ */
+static void
+run_find_steps(void)
+{
+    static const unsigned  image = 4096;
+    static const unsigned  rec_size = 120;
+    static const unsigned  budgets[] = { 0, 32, 64, 128, 256 };
+    const EeIdent          want = MK4CODE('S','T','E','P');
+
+    if( ! EeStorage::open( s_path, image ) )
+        return;
+
+    memset( EeStorage::image(), 0xFF, image );
+#if EEVALUES_CONF_CACHE_LINES
+    EeStorage::invalidate();
+#endif
+
+    EeValues  rec( want );
+    rec.setUserDataPtr( s_user );
+    rec.setUserSize( rec_size );
+    memset( s_user, 0x3C, rec_size );
+    rec.updateCrc8();
+
+    for( unsigned  i = 0 ; i < 9 ; ++i )
+    {
+        rec.setEeOffset( IMAGE_BASE + 64 + i * 400 );
+        rec.writeToEe();
+        if( i < 8 )     // a stale copy: right ident, wrong CRC
+            EeStorage::writeByte( rec.eeOffsetOfUserRecord(), 0x00 );
+    }
+    const eeoffset_t  real = rec.eeOffsetOfHeader();
+
+    for( unsigned  b = 0 ; b < sizeof(budgets) / sizeof(budgets[0]) ; ++b )
+    {
+        unsigned long long  slowest = ~0ULL;
+        unsigned long long  total = 0;
+        unsigned long       most_reads = 0;
+        unsigned            steps = 0;
+        boolean             ok = true;
+
+        for( unsigned  n = 0 ; n < REPEAT ; ++n )
+        {
+            unsigned long long  worst = 0;
+            const unsigned long long  t0 = now_ns();
+
+            rec.setEeOffset( 0 );
+            steps = 0;
+
+            if( budgets[b] == 0 )
+            {
+                RESET_COUNTERS();
+                ok = ok && rec.findHeader();
+                worst = now_ns() - t0;
+                most_reads = EeStorage::bytesRead();
+                steps = 1;
+            }
+            else
+            {
+                EeFinder  finder;
+                EeFinder::Status  st;
+
+                finder.begin( rec );
+                do
+                {
+                    RESET_COUNTERS();
+                    const unsigned long long  s0 = now_ns();
+                    st = finder.step( budgets[b] );
+                    const unsigned long long  ns = now_ns() - s0;
+
+                    if( ns > worst )
+                        worst = ns;
+                    if( EeStorage::bytesRead() > most_reads )
+                        most_reads = EeStorage::bytesRead();
+                    ++steps;
+                } while( st == EeFinder::IN_PROGRESS );
+
+                ok = ok && st == EeFinder::FOUND;
+            }
+
+            total += now_ns() - t0;
+            if( worst < slowest )
+                slowest = worst;
+            ok = ok && rec.eeOffsetOfHeader() == real;
+        }
+
+        printf( "{\"op\":\"find_steps\",\"image\":%u,\"stale\":8,\"rec_size\":%u,\"budget\":%u,\"steps\":%u,"
+                "\"max_step_reads\":%lu,\"max_step_ns\":%llu,\"total_ns\":%llu,\"ok\":%s}\n",
+                image, rec_size, budgets[b], steps, most_reads, slowest, total / REPEAT, ok_json( ok ) );
+    }
+}
+
+
+/***
+ *   Erasing all of EEMEM, as MyIdent's 'E' command does, on a part that
+ *   is blank but for a few records: a plain fill() of every byte against
+ *   eraseEe(), which reads first and skips bytes already 0xFF.
+ */
+static void
+run_erase(void)
+{
+    static const unsigned  image = 4096;
+
+    for( int  skip = 0 ; skip < 2 ; ++skip )
+    {
+        if( ! EeStorage::open( s_path, image ) )
+            return;
+
+        memset( EeStorage::image(), 0xFF, image );
+        for( unsigned  i = 0 ; i < 4 ; ++i )
+            memset( EeStorage::image() + 100 + i * 1000, 0x5A, 40 );
+#if EEVALUES_CONF_CACHE_LINES
+        EeStorage::invalidate();
+#endif
+
+        RESET_COUNTERS();
+        const unsigned long long  t0 = now_ns();
+        if( skip )
+            EeValues::eraseEe( 0, image );
+        else
+            EeStorage::fill( 0, 0xFF, image );
+        const unsigned long long  ns = now_ns() - t0;
+
+        boolean  ok = true;
+        for( unsigned  i = 0 ; i < image ; ++i )
+            ok = ok && EeStorage::image()[i] == 0xFF;
+
+        printf( "{\"op\":\"erase_all\",\"method\":\"%s\",\"image\":%u,\"ns\":%llu,\"reads\":%lu,"
+                "\"writes\":%lu,\"busy_ms\":%.1f,\"ok\":%s}\n",
+                skip ? "eraseEe" : "fill", image, ns, EeStorage::bytesRead(), EeStorage::bytesWritten(),
+                EeStorage::busyMicros() / 1000.0, ok_json( ok ) );
+    }
+}
+
+
+/***
+ *   A dozen 16 byte records, once as long-lived EeValues objects and
+ *   once as PROGMEM descriptors.  Gives RAM held between operations and
+ *   descriptor bytes in flash -- on this host and, from the layout, on an
+ *   AVR, where pointers are 2 bytes -- and the cost of saving and loading
+ *   the whole set with one change per record.
+ */
+#define DESC_RECORDS    12
+#define DESC_SIZE       16
+#define DESC(_i)        EE_DESCRIPTOR_INIT( MK4CODE('D','S','C','A' + (_i)), IMAGE_BASE + 64 + (_i) * 32, DESC_SIZE, 0 )
+
+static const EeDescriptor  s_descs[DESC_RECORDS] PROGMEM =
+{
+    DESC(0), DESC(1), DESC(2), DESC(3), DESC(4), DESC(5),
+    DESC(6), DESC(7), DESC(8), DESC(9), DESC(10), DESC(11)
+};
+
+static void
+run_descriptor(void)
+{
+    static const unsigned  image = 1024;
+    static uint8_t         data[DESC_RECORDS][DESC_SIZE];
+    static uint8_t         back[DESC_RECORDS][DESC_SIZE];
+
+    for( int  desc = 0 ; desc < 2 ; ++desc )
+    {
+        if( ! EeStorage::open( s_path, image ) )
+            return;
+        memset( EeStorage::image(), 0xFF, image );
+#if EEVALUES_CONF_CACHE_LINES
+        EeStorage::invalidate();
+#endif
+
+        EeValues *  recs[DESC_RECORDS];
+
+        for( unsigned  i = 0 ; i < DESC_RECORDS ; ++i )
+        {
+            memset( data[i], 0x30 + i, DESC_SIZE );
+            EeDesc::save( &s_descs[i], data[i] );
+
+            EeDescriptor  d;
+            EeDesc::read( &s_descs[i], &d );
+            recs[i] = new EeValues( d.m_ident );
+            recs[i]->setUserDataPtr( data[i] );
+            recs[i]->setUserSize( DESC_SIZE );
+            recs[i]->setEeOffset( d.m_offset );
+        }
+
+        RESET_COUNTERS();
+        unsigned long long  t0 = now_ns();
+        for( unsigned  r = 0 ; r < REPEAT ; ++r )
+        {
+            for( unsigned  i = 0 ; i < DESC_RECORDS ; ++i )
+            {
+                data[i][r % DESC_SIZE] += 1;
+                if( desc )
+                    EeDesc::save( &s_descs[i], data[i] );
+                else
+                    ( recs[i]->updateCrc8(), recs[i]->writeChangedToEe() );
+            }
+        }
+        const unsigned long long  save_ns = now_ns() - t0;
+        const unsigned long       writes = EeStorage::bytesWritten();
+
+        boolean  ok = true;
+
+        t0 = now_ns();
+        for( unsigned  r = 0 ; r < REPEAT ; ++r )
+        {
+            for( unsigned  i = 0 ; i < DESC_RECORDS ; ++i )
+            {
+                if( desc )
+                    ok = EeDesc::load( &s_descs[i], back[i] ) && ok;
+                else
+                    ok = ( recs[i]->setUserDataPtr( back[i] ), recs[i]->loadIfValid() ) && ok;
+            }
+        }
+        const unsigned long long  load_ns = now_ns() - t0;
+
+        ok = ok && memcmp( back, data, sizeof(data) ) == 0;
+
+        for( unsigned  i = 0 ; i < DESC_RECORDS ; ++i )
+            delete recs[i];
+
+        const unsigned  ram = desc ? 0 : DESC_RECORDS * sizeof(EeValues);
+        const unsigned  avr_ram = desc ? 0 : DESC_RECORDS * ( EeValues::HEADER_SIZE + sizeof(eeoffset_t) + 2 );
+        const unsigned  flash = desc ? sizeof(s_descs) : 0;
+        const unsigned  avr_flash = desc ? DESC_RECORDS * ( sizeof(EeIdent) + sizeof(eeoffset_t) + sizeof(eesize_t) + EEVALUES_CONF_SCHEMA ) : 0;
+
+        printf( "{\"op\":\"descriptor\",\"method\":\"%s\",\"records\":%u,\"rec_size\":%u,"
+                "\"ram\":%u,\"avr_ram\":%u,\"flash_data\":%u,\"avr_flash_data\":%u,"
+                "\"save_ns\":%llu,\"load_ns\":%llu,\"writes\":%lu,\"ok\":%s}\n",
+                desc ? "EeDescriptor" : "EeValues", DESC_RECORDS, DESC_SIZE,
+                ram, avr_ram, flash, avr_flash,
+                save_ns / REPEAT, load_ns / REPEAT, writes / REPEAT, ok_json( ok ) );
+    }
+}
+
+
+/***
+ *   A 24 byte record gains a 4 byte field, either appended or inserted
+ *   in front.  'rewrite' is the old way: defaults plus a full
+ *   writeToEe() ; 'migrate' is EeSchema::loadOrMigrate() keeping the
+ *   stored values.  With EEVALUES_CONF_SCHEMA, 'legacy' appends to a
+ *   record stored with the header of a build without it.  Gives bytes
+ *   written and whether the values survived.
+ */
+static const EeFieldMap   s_append_fields[] PROGMEM = { { 0, 0, 24 } };
+static const EeFieldMap   s_insert_fields[] PROGMEM = { { 0, 4, 24 } };
+static const EeMigration  s_append_steps[] PROGMEM = { { 0, 24, s_append_fields, 1 } };
+static const EeMigration  s_insert_steps[] PROGMEM = { { 0, 24, s_insert_fields, 1 } };
+
+static void
+run_migrate(void)
+{
+    static const unsigned  image = 1024;
+    static const EeIdent   id = MK4CODE('M','I','G','R');
+
+    static const char * const  changes[] = { "append", "insert", "legacy" };
+
+    for( int  change = 0 ; change < 2 + EEVALUES_CONF_SCHEMA ; ++change )
+      for( int  migrate = 0 ; migrate < 2 ; ++migrate )
+      {
+        const boolean  insert = change == 1;
+
+        if( ! EeStorage::open( s_path, image ) )
+            return;
+        memset( EeStorage::image(), 0xFF, image );
+#if EEVALUES_CONF_CACHE_LINES
+        EeStorage::invalidate();
+#endif
+
+        uint8_t  old_data[24];
+        uint8_t  new_data[28];
+
+        for( unsigned  i = 0 ; i < sizeof(old_data) ; ++i )
+            old_data[i] = (uint8_t) (0x40 + i);
+
+#if EEVALUES_CONF_SCHEMA
+        if( change == 2 )
+        {
+            EeLegacyHeader  hdr;
+            hdr.m_ident = id;
+            hdr.m_full_size = sizeof(hdr) + sizeof(old_data);
+#if _EESCHEMA_LEGACY_HDR_FORMAT
+            hdr.m_format = _EESCHEMA_LEGACY_FORMAT;
+#endif
+            hdr.m_crc = EeCrc::block( EeCrc::block( EeCrc::seed(), (const uint8_t *) &hdr + sizeof(hdr.m_crc),
+                                                    sizeof(hdr) - sizeof(hdr.m_crc) ),
+                                      old_data, sizeof(old_data) );
+            EeStorage::writeBlock( IMAGE_BASE + 100, &hdr, sizeof(hdr) );
+            EeStorage::writeBlock( IMAGE_BASE + 100 + sizeof(hdr), old_data, sizeof(old_data) );
+        }
+        else
+#endif
+        {
+            EeValues  old_rec( id );
+            old_rec.setUserDataPtr( old_data );
+            old_rec.setUserSize( sizeof(old_data) );
+            old_rec.setEeOffset( IMAGE_BASE + 100 );
+            old_rec.updateCrc8();
+            old_rec.writeToEe();
+        }
+
+        //  Defaults, then the new record at the same place.
+        memset( new_data, 0, sizeof(new_data) );
+
+        EeValues  rec( id );
+        rec.setUserDataPtr( new_data );
+        rec.setUserSize( sizeof(new_data) );
+        rec.setEeOffset( IMAGE_BASE + 100 );
+#if EEVALUES_CONF_SCHEMA
+        rec.setSchema( 1 );
+#endif
+
+        RESET_COUNTERS();
+        const unsigned long long  t0 = now_ns();
+        if( migrate )
+        {
+            EeSchema::loadOrMigrate( rec, insert ? s_insert_steps : s_append_steps, 1 );
+        }
+        else if( ! rec.loadIfValid() )
+        {
+            memset( new_data, 0, sizeof(new_data) );
+            rec.updateCrc8();
+            rec.writeToEe();
+        }
+        const unsigned long long  ns = now_ns() - t0;
+
+        //  Kept: old values where the new layout puts them.
+        const boolean  kept = memcmp( new_data + ( insert ? 4 : 0 ), old_data, sizeof(old_data) ) == 0;
+
+        memset( new_data, 0, sizeof(new_data) );
+        const boolean  ok = rec.loadIfValid() && ( kept || ! migrate );
+
+        printf( "{\"op\":\"migrate\",\"method\":\"%s\",\"change\":\"%s\",\"old_size\":%u,\"new_size\":%u,"
+                "\"ns\":%llu,\"reads\":%lu,\"writes\":%lu,\"busy_ms\":%.1f,\"kept\":%s,\"ok\":%s}\n",
+                migrate ? "migrate" : "rewrite", changes[change],
+                (unsigned) sizeof(old_data), (unsigned) sizeof(new_data),
+                ns, EeStorage::bytesRead(), EeStorage::bytesWritten(), EeStorage::busyMicros() / 1000.0,
+                kept ? "true" : "false", ok_json( ok ) );
+      }
+}
+
+
+/***
+ *   A settings save: five 24 byte records, with either two bytes or every
+ *   byte of each changed.  'writeToEe' and 'writeChangedToEe' seal and
+ *   write one record after another ; 'EeBatch' commits the five at once
+ *   through its journal.  Gives bytes written, modelled busy time, and
+ *   host time per save.
+ */
+#define BATCH_RECORDS   5
+#define BATCH_SIZE      24
+#define BATCH_JOURNAL   (IMAGE_BASE + 400)
+#define BATCH_JSIZE     240
+
+static void
+run_batch(void)
+{
+    static const unsigned      image = 1024;
+    static const char * const  methods[] = { "writeToEe", "writeChangedToEe", "EeBatch" };
+    static uint8_t             data[BATCH_RECORDS][BATCH_SIZE];
+    static uint8_t             back[BATCH_SIZE];
+
+    for( int  all = 0 ; all < 2 ; ++all )
+      for( int  method = 0 ; method < 3 ; ++method )
+      {
+        if( ! EeStorage::open( s_path, image ) )
+            return;
+        memset( EeStorage::image(), 0xFF, image );
+#if EEVALUES_CONF_CACHE_LINES
+        EeStorage::invalidate();
+#endif
+
+        EeValues *  recs[BATCH_RECORDS];
+        EeValues *  table[BATCH_RECORDS];
+        EeBatch     batch( BATCH_JOURNAL, BATCH_JSIZE, table, BATCH_RECORDS );
+
+        for( unsigned  i = 0 ; i < BATCH_RECORDS ; ++i )
+        {
+            memset( data[i], 0x30 + i, BATCH_SIZE );
+            recs[i] = new EeValues( MK4CODE('B','A','T','A' + i) );
+            recs[i]->setUserDataPtr( data[i] );
+            recs[i]->setUserSize( BATCH_SIZE );
+            recs[i]->setEeOffset( IMAGE_BASE + 64 + i * 48 );
+            recs[i]->updateCrc8();
+            recs[i]->writeToEe();
+        }
+
+        RESET_COUNTERS();
+        const unsigned long long  t0 = now_ns();
+        int  failed = 0;
+        for( unsigned  r = 0 ; r < REPEAT ; ++r )
+        {
+            for( unsigned  i = 0 ; i < BATCH_RECORDS ; ++i )
+            {
+                if( all )
+                    memset( data[i], (uint8_t) ( 0x30 + i + ( r + 1 ) * 0x40 ), BATCH_SIZE );
+                else
+                    ( data[i][r % BATCH_SIZE] += 1, data[i][( r + 7 ) % BATCH_SIZE] += 1 );
+
+                if( method == 2 )
+                    batch.add( *recs[i] );
+                else if( method == 1 )
+                    ( recs[i]->updateCrc8(), recs[i]->writeChangedToEe() );
+                else
+                    ( recs[i]->updateCrc8(), recs[i]->writeToEe() );
+            }
+            if( method == 2 && batch.commit() < 0 )
+                ++failed;
+        }
+        const unsigned long long  ns = now_ns() - t0;
+
+        boolean  ok = failed == 0;
+        for( unsigned  i = 0 ; i < BATCH_RECORDS ; ++i )
+        {
+            recs[i]->setUserDataPtr( back );
+            ok = recs[i]->loadIfValid() && memcmp( back, data[i], BATCH_SIZE ) == 0 && ok;
+            delete recs[i];
+        }
+
+        printf( "{\"op\":\"batch\",\"method\":\"%s\",\"change\":\"%s\",\"records\":%u,\"rec_size\":%u,"
+                "\"ns\":%llu,\"reads\":%lu,\"writes\":%lu,\"busy_ms\":%.1f,\"atomic\":%s,\"ok\":%s}\n",
+                methods[method], all ? "all" : "two", BATCH_RECORDS, BATCH_SIZE,
+                ns / REPEAT, EeStorage::bytesRead() / REPEAT, EeStorage::bytesWritten() / REPEAT,
+                EeStorage::busyMicros() / 1000.0 / REPEAT,
+                method == 2 ? "true" : "false", ok_json( ok ) );
+      }
+}
+
+
+int
+main( int argc, char ** argv )
+{
+    if( argc > 1 )
+        s_path = argv[1];
+
+    for( unsigned  i = 0 ; i < sizeof(image_sizes) / sizeof(image_sizes[0]) ; ++i )
+      for( unsigned  j = 0 ; j < sizeof(record_counts) / sizeof(record_counts[0]) ; ++j )
+        for( unsigned  k = 0 ; k < sizeof(record_sizes) / sizeof(record_sizes[0]) ; ++k )
+          for( int  p = POS_FIRST ; p <= POS_LAST ; ++p )
+          {
+              Case  c = { image_sizes[i], record_counts[j], record_sizes[k], (Position) p };
+
+              //  Record must fit in its share of the image.
+              if( c.rec_size + 16 > c.stride() )
+                  continue;
+              //  With one record, every position is the same.
+              if( c.records == 1 && p != POS_FIRST )
+                  continue;
+
+              run_case( c );
+          }
+
+#if EEVALUES_CONF_CRC == EEVALUES_CRC8_LIB
+    run_crc< EEVALUES_CRC8_LIB >( "crc8_lib", 0 );
+#endif
+    run_crc< EEVALUES_CRC8_NIBBLE >( "crc8_nibble", 16 );
+    run_crc< EEVALUES_CRC8_TABLE >( "crc8_table", 256 );
+    run_crc< EEVALUES_CRC16_CCITT >( "crc16_ccitt", 0 );
+
+    run_paged();
+    run_compress();
+#if EEVALUES_CONF_TRACE && EEVALUES_CONF_TRACE_WEAR
+    run_wear();
+#endif
+    run_find_steps();
+    run_erase();
+    run_kv();
+    run_descriptor();
+    run_migrate();
+    run_batch();
+
+    EeStorage::close();
+    return( s_failed ? 1 : 0 );
+}
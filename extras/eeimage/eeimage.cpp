@@ -0,0 +1,891 @@
+/** eeimage.cpp ** Build, dump, verify and patch EEMEM images on the host **  Oct 2026 **/
+/*
+ *  Provisioning with a sketch means every board writes its default
+ *  records one EEMEM byte at a time, seconds per unit.  eeimage builds
+ *  the whole image on the host instead, through the same EeValues header
+ *  and CRC code running on the mmap() back-end, so the programmer does
+ *  one bulk upload:
+ *
+ *      eeimage build board.spec unit%04u.eep -n 500 -u 1000
+ *      avrdude ... -U eeprom:w:unit1000.eep:i
+ *
+ *  usage:
+ *      eeimage build  SPEC OUT [ -n COUNT ] [ -u FIRST ]
+ *      eeimage dump   IMAGE [ -s SIZE ]
+ *      eeimage verify IMAGE SPEC [ -u UNIT ]
+ *      eeimage patch  IMAGE IDENT OFFSET FIELD... [ -u UNIT ] [ -o OUT ]
+ *
+ *  Files named "*.bin" are raw bytes ; any other name, e.g. "*.eep" or
+ *  "*.hex", is Intel HEX, as the IDE and avrdude use for EEMEM.
+ *
+ *  A SPEC is a text file ; '#' starts a comment.
+ *
+ *      size    1024                    # EEMEM bytes, E2END + 1
+ *      blank   0xFF                    # erased value ( the default )
+ *      record  SNUM  16    str=3:SN- serial=8
+ *      record  CALB  next  u16=512 u16=0x7FF0 hex=0A0B0C fill=4:0
+ *
+ *  'record' gives the ident ( 4 characters, or 0x hex as EeIdent ), the
+ *  header's EE offset, or 'next' for just after the previous record, and
+ *  the fields making up its user data, in order, little-endian:
+ *
+ *      u8=V  u16=V  u32=V      integer, decimal or 0x hex
+ *      hex=0A0B..              raw bytes
+ *      str=LEN:TEXT            TEXT, NUL padded to LEN bytes
+ *      fill=LEN:V              LEN bytes of V
+ *      serial=LEN              unit number, as LEN decimal digits
+ *      serial=u16  serial=u32  unit number, binary
+ *
+ *  and, built with SCHEMA=1, 'schema=N' anywhere on the line sets the
+ *  header's schema version.
+ *
+ *  build writes COUNT images ( default 1 ) for units FIRST, FIRST + 1 ...
+ *  ( default 0 ) ; with COUNT above 1, OUT holds a printf() "%u" for the
+ *  unit number.  It prints the rate reached, in images per second.
+ *
+ *  dump lists every valid record, found with an EeDirectory scan.
+ *
+ *  verify hunts for each record of SPEC with findHeader(), as a sketch
+ *  would at boot, and checks its offset and user data.  Serial fields
+ *  are only compared when -u gives the unit.  Exit status 1 on mismatch.
+ *
+ *  patch overwrites user data of record IDENT from user offset OFFSET
+ *  with FIELDs, then updates the CRC ; only changed bytes are written.
+ *
+ *  The image must be built with the sketch's EEVALUES_CONF_CRC,
+ *  EEVALUES_CONF_LARGE, EEVALUES_CONF_SCHEMA and EEVALUES_CONF_SUPERBLOCK ;
+ *  see the Makefile.
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <EeValues.h>
+#include <EeDirectory.h>
+#include <EeSuperblock.h>
+
+/* ------------------------------------------------------------------- */
+
+#define MAX_RECORDS     64
+#define MAX_FIELDS      32
+#define MAX_LINE        4096
+#define USER_MAX        ((unsigned) EEVALUES_MAX_FULL_SIZE)
+
+//  Unit number not given ; serial fields are "don't care".
+#define NO_UNIT         (~0UL)
+
+struct SpecRecord
+{
+    EeIdent         ident;
+    unsigned long   offset;             // EE offset of header
+    unsigned        user_size;
+    uint8_t         schema;
+    unsigned        nfields;
+    char *          fields[MAX_FIELDS];
+};
+
+static unsigned long  s_size = EEVALUES_EE_SIZE;
+static uint8_t        s_blank = 0xFF;
+static SpecRecord     s_records[MAX_RECORDS];
+static unsigned       s_nrecords;
+
+static char           s_scratch[64];    // mmap() file behind EeStorage
+static uint8_t        s_user[USER_MAX];
+static uint8_t        s_care[USER_MAX];
+static uint8_t        s_have[USER_MAX];
+static char *         s_hex;            // Intel HEX text of one image
+
+/* ------------------------------------------------------------------- */
+
+static void
+die( const char * fmt, ... )
+{
+    va_list  ap;
+
+    va_start( ap, fmt );
+    fprintf( stderr, "eeimage: " );
+    vfprintf( stderr, fmt, ap );
+    fprintf( stderr, "\n" );
+    va_end( ap );
+
+    exit( 2 );
+}
+
+
+static unsigned long long
+now_ns(void)
+{
+    struct timespec  ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+static unsigned long
+parse_number( const char * text, const char * what )
+{
+    char *  end;
+
+    errno = 0;
+    unsigned long  v = strtoul( text, &end, 0 );
+    if( *text == '\0' || *end != '\0' || errno != 0 )
+        die( "bad %s '%s'", what, text );
+    return( v );
+}
+
+
+//  Four characters, e.g. "SNUM", or a number such as "0x4D554E53".
+static EeIdent
+parse_ident( const char * text )
+{
+    if( strlen( text ) == sizeof(EeIdent) )
+        return MK4CODE( text[0], text[1], text[2], text[3] );
+
+    return (EeIdent) parse_number( text, "ident" );
+}
+
+
+static const char *
+ident_text( EeIdent id )
+{
+    static char  text[12];
+
+    for( unsigned  i = 0 ; i < sizeof(EeIdent) ; ++i )
+    {
+        const uint8_t  c = (uint8_t) (id >> (8 * i));
+        if( c < ' ' || c > '~' )
+        {
+            snprintf( text, sizeof(text), "0x%08lX", (unsigned long) id );
+            return( text );
+        }
+        text[i] = c;
+    }
+
+    text[sizeof(EeIdent)] = '\0';
+    return( text );
+}
+
+
+static int
+hex_digit( char c )
+{
+    if( c >= '0' && c <= '9' )  return c - '0';
+    if( c >= 'A' && c <= 'F' )  return c - 'A' + 10;
+    if( c >= 'a' && c <= 'f' )  return c - 'a' + 10;
+    return( -1 );
+}
+
+/* ------------------------------------------------------------------- */
+
+/***
+ *   Append the bytes of one field to 'dst' at '*len', 'max' bytes at
+ *   most.  Serial fields take 'unit' ; with NO_UNIT they hold zeros and
+ *   their bytes in 'care' are cleared.  'care' may be NULL.
+ */
+static void
+encode_field( const char * field, unsigned long unit, uint8_t * dst, uint8_t * care, unsigned * len, unsigned max )
+{
+    const char *  eq = strchr( field, '=' );
+    if( eq == NULL )
+        die( "field '%s' has no '='", field );
+
+    const size_t   klen = eq - field;
+    const char *   arg = eq + 1;
+    unsigned       n = 0;
+    static uint8_t bytes[USER_MAX];
+    boolean        is_serial = false;
+
+#define KEY_IS(_k)  ( klen == sizeof(_k) - 1 && strncmp( field, _k, klen ) == 0 )
+
+    if( KEY_IS( "u8" ) || KEY_IS( "u16" ) || KEY_IS( "u32" ) )
+    {
+        const unsigned long  v = parse_number( arg, "integer" );
+
+        n = KEY_IS( "u8" ) ? 1 : KEY_IS( "u16" ) ? 2 : 4;
+        if( (unsigned long long) v >> (8 * n) != 0 )
+            die( "'%s' does not fit", field );
+        for( unsigned  i = 0 ; i < n ; ++i )
+            bytes[i] = (uint8_t) (v >> (8 * i));
+    }
+    else if( KEY_IS( "hex" ) )
+    {
+        for( ; arg[0] != '\0' ; arg += 2 )
+        {
+            if( hex_digit( arg[0] ) < 0 || hex_digit( arg[1] ) < 0 )
+                die( "bad hex in '%s'", field );
+            bytes[n++] = (uint8_t) (hex_digit( arg[0] ) << 4 | hex_digit( arg[1] ));
+        }
+    }
+    else if( KEY_IS( "str" ) || KEY_IS( "fill" ) )
+    {
+        char *  colon;
+        n = strtoul( arg, &colon, 10 );
+        if( *colon != ':' || n > sizeof(bytes) )
+            die( "'%s' wants LEN:VALUE", field );
+
+        if( KEY_IS( "str" ) )
+        {
+            if( strlen( colon + 1 ) > n )
+                die( "'%s' is longer than %u", field, n );
+            memset( bytes, 0, n );
+            memcpy( bytes, colon + 1, strlen( colon + 1 ) );
+        }
+        else
+        {
+            const unsigned long  v = parse_number( colon + 1, "fill value" );
+            if( v > 0xFF )
+                die( "'%s' does not fit", field );
+            memset( bytes, (int) v, n );
+        }
+    }
+    else if( KEY_IS( "serial" ) )
+    {
+        const unsigned long  v = unit == NO_UNIT ? 0 : unit;
+
+        is_serial = true;
+        if( strcmp( arg, "u16" ) == 0 || strcmp( arg, "u32" ) == 0 )
+        {
+            n = arg[1] == '1' ? 2 : 4;
+            for( unsigned  i = 0 ; i < n ; ++i )
+                bytes[i] = (uint8_t) (v >> (8 * i));
+        }
+        else
+        {
+            n = parse_number( arg, "serial width" );
+            if( n == 0 || n > 20 )
+                die( "bad serial width in '%s'", field );
+
+            unsigned long  w = v;
+            for( unsigned  i = n ; i-- > 0 ; w /= 10 )
+                bytes[i] = (uint8_t) ('0' + w % 10);
+            if( w != 0 )
+                die( "unit %lu has more than %u digits", v, n );
+        }
+    }
+    else
+    {
+        die( "unknown field '%s'", field );
+    }
+
+#undef KEY_IS
+
+    if( *len + n > max )
+        die( "user data too big at '%s'", field );
+
+    memcpy( dst + *len, bytes, n );
+    if( care != NULL )
+        memset( care + *len, is_serial && unit == NO_UNIT ? 0 : 1, n );
+    *len += n;
+}   /* end encode_field() */
+
+
+static unsigned
+encode_record( const SpecRecord & r, unsigned long unit, uint8_t * care )
+{
+    unsigned  len = 0;
+
+    for( unsigned  i = 0 ; i < r.nfields ; ++i )
+        encode_field( r.fields[i], unit, s_user, care, &len, USER_MAX - EeValues::HEADER_SIZE );
+    return( len );
+}
+
+/* ------------------------------------------------------------------- */
+
+/***
+ *   Read 'path' into s_records.  Each record is encoded once here, to get
+ *   its size, resolve 'next' offsets and catch overlaps before any image
+ *   is written.
+ */
+static void
+load_spec( const char * path )
+{
+    FILE *  f = fopen( path, "r" );
+    if( f == NULL )
+        die( "%s: %s", path, strerror( errno ) );
+
+    char      line[MAX_LINE];
+    unsigned  lineno = 0;
+
+    while( fgets( line, sizeof(line), f ) != NULL )
+    {
+        ++lineno;
+
+        char *  hash = strchr( line, '#' );
+        if( hash != NULL )
+            *hash = '\0';
+
+        char *  words[MAX_FIELDS + 3];
+        unsigned  nwords = 0;
+
+        for( char *  w = strtok( line, " \t\r\n" ) ; w != NULL ; w = strtok( NULL, " \t\r\n" ) )
+        {
+            if( nwords == sizeof(words) / sizeof(words[0]) )
+                die( "%s:%u: more than %u fields", path, lineno, MAX_FIELDS );
+            words[nwords++] = w;
+        }
+
+        if( nwords == 0 )
+            continue;
+
+        if( strcmp( words[0], "size" ) == 0 && nwords == 2 )
+        {
+            s_size = parse_number( words[1], "size" );
+        }
+        else if( strcmp( words[0], "blank" ) == 0 && nwords == 2 )
+        {
+            s_blank = (uint8_t) parse_number( words[1], "blank value" );
+        }
+        else if( strcmp( words[0], "record" ) == 0 && nwords >= 3 )
+        {
+            if( s_nrecords == MAX_RECORDS )
+                die( "%s:%u: more than %u records", path, lineno, MAX_RECORDS );
+
+            SpecRecord &  r = s_records[s_nrecords];
+
+            r.ident = parse_ident( words[1] );
+            r.schema = 0;
+            r.nfields = 0;
+            for( unsigned  i = 3 ; i < nwords ; ++i )
+            {
+                if( strncmp( words[i], "schema=", 7 ) != 0 )
+                    r.fields[r.nfields++] = strdup( words[i] );
+#if EEVALUES_CONF_SCHEMA
+                else
+                {
+                    const unsigned long  v = parse_number( words[i] + 7, "schema" );
+                    if( v > 0xFF )
+                        die( "%s:%u: schema over 255", path, lineno );
+                    r.schema = (uint8_t) v;
+                }
+#else
+                else
+                    die( "%s:%u: schema needs a SCHEMA=1 build", path, lineno );
+#endif
+            }
+            r.user_size = encode_record( r, 0, NULL );
+
+            if( strcmp( words[2], "next" ) != 0 )
+                r.offset = parse_number( words[2], "offset" );
+            else if( s_nrecords > 0 )
+                r.offset = s_records[s_nrecords - 1].offset + EeValues::HEADER_SIZE + s_records[s_nrecords - 1].user_size;
+#if EEVALUES_CONF_SUPERBLOCK
+            else
+                r.offset = EeSuperblock::END;
+#else
+            else
+                r.offset = 0;
+#endif
+            ++s_nrecords;
+        }
+        else
+        {
+            die( "%s:%u: expected size, blank or record", path, lineno );
+        }
+    }
+
+    fclose( f );
+
+    //  Every record inside EEMEM, clear of the others and the superblock.
+    for( unsigned  i = 0 ; i < s_nrecords ; ++i )
+    {
+        const SpecRecord &   r = s_records[i];
+        const unsigned long  end = r.offset + EeValues::HEADER_SIZE + r.user_size;
+
+        if( end > s_size )
+            die( "%s: record %s ends at %lu, past EEMEM size %lu", path, ident_text( r.ident ), end, s_size );
+#if EEVALUES_CONF_SUPERBLOCK
+        if( r.offset < EeSuperblock::END && end > EeSuperblock::OFFSET )
+            die( "%s: record %s overlaps the superblock", path, ident_text( r.ident ) );
+#endif
+        for( unsigned  j = 0 ; j < i ; ++j )
+        {
+            const SpecRecord &  o = s_records[j];
+
+            if( r.ident == o.ident )
+                die( "%s: ident %s used twice", path, ident_text( r.ident ) );
+            if( r.offset < o.offset + EeValues::HEADER_SIZE + o.user_size && o.offset < end )
+                die( "%s: records %s and %s overlap", path, ident_text( o.ident ), ident_text( r.ident ) );
+        }
+    }
+}   /* end load_spec() */
+
+/* ------------------------------------------------------------------- */
+
+//  Map a fresh scratch EEMEM of 'size' bytes.  The file is unlinked at
+//  once ; the mapping keeps it alive until exit.
+static void
+open_scratch( unsigned long size )
+{
+    snprintf( s_scratch, sizeof(s_scratch), "/tmp/eeimage.%ld", (long) getpid() );
+    unlink( s_scratch );
+
+    if( size == 0 || size - 1 > (eeoffset_t) -1 )
+        die( "EEMEM size %lu out of range ; LARGE=1 for parts over 64 KB", size );
+    if( ! EeMmapStorage::open( s_scratch, size, 0 ) )
+        die( "%s: %s", s_scratch, strerror( errno ) );
+
+    unlink( s_scratch );
+}
+
+
+static boolean
+is_raw( const char * path )
+{
+    const size_t  n = strlen( path );
+    return( n >= 4 && strcmp( path + n - 4, ".bin" ) == 0 );
+}
+
+
+//  Two hex digits of 'v' at 'p', and add 'v' to the record checksum.
+static char *
+put_hex( char * p, uint8_t v, uint8_t * sum )
+{
+    static const char  digits[] = "0123456789ABCDEF";
+
+    *p++ = digits[v >> 4];
+    *p++ = digits[v & 15];
+    *sum += v;
+    return( p );
+}
+
+
+static char *
+put_hex_record( char * p, uint8_t type, unsigned addr, const uint8_t * data, unsigned n )
+{
+    uint8_t  sum = 0;
+
+    *p++ = ':';
+    p = put_hex( p, (uint8_t) n, &sum );
+    p = put_hex( p, (uint8_t) (addr >> 8), &sum );
+    p = put_hex( p, (uint8_t) addr, &sum );
+    p = put_hex( p, type, &sum );
+    for( unsigned  i = 0 ; i < n ; ++i )
+        p = put_hex( p, data[i], &sum );
+    p = put_hex( p, (uint8_t) -sum, &sum );
+    *p++ = '\n';
+    return( p );
+}
+
+
+/***
+ *   Write the scratch EEMEM to 'path', raw or as Intel HEX: 16 data bytes
+ *   per line, an extended linear address record at each 64 KB boundary,
+ *   then end-of-file.  The text is built in memory and written at once.
+ */
+static void
+save_image( const char * path )
+{
+    const uint8_t *      image = EeMmapStorage::image();
+    const unsigned long  size = EeStorage::size();
+    const void *         out = image;
+    size_t               len = size;
+
+    if( ! is_raw( path ) )
+    {
+        if( s_hex == NULL )
+            s_hex = (char *) malloc( (size + 15) / 16 * 44 + (size >> 16) * 16 + 16 );
+
+        char *  p = s_hex;
+
+        for( unsigned long  addr = 0 ; addr < size ; addr += 16 )
+        {
+            if( addr > 0xFFFF && (addr & 0xFFFF) == 0 )
+            {
+                const uint8_t  upper[2] = { (uint8_t) (addr >> 24), (uint8_t) (addr >> 16) };
+                p = put_hex_record( p, 4, 0, upper, 2 );
+            }
+            p = put_hex_record( p, 0, (unsigned) (addr & 0xFFFF), image + addr,
+                                size - addr < 16 ? (unsigned) (size - addr) : 16 );
+        }
+        p = put_hex_record( p, 1, 0, NULL, 0 );
+
+        out = s_hex;
+        len = p - s_hex;
+    }
+
+    FILE *  f = fopen( path, "wb" );
+    if( f == NULL || fwrite( out, 1, len, f ) != len || fclose( f ) != 0 )
+        die( "%s: %s", path, strerror( errno ) );
+}   /* end save_image() */
+
+
+/***
+ *   Read 'path' into the scratch EEMEM.  Raw files set the size unless
+ *   'size' is given ; Intel HEX sets it to one past its highest byte.
+ *   Bytes the file doesn't cover read as the blank value.
+ */
+static void
+load_image( const char * path, unsigned long size )
+{
+    FILE *  f = fopen( path, "rb" );
+    if( f == NULL )
+        die( "%s: %s", path, strerror( errno ) );
+
+    size_t     cap = 4096;
+    size_t     len = 0;
+    uint8_t *  text = (uint8_t *) malloc( cap );
+
+    for( size_t  n ; ( n = fread( text + len, 1, cap - len, f ) ) > 0 ; )
+    {
+        len += n;
+        if( len == cap )
+            text = (uint8_t *) realloc( text, cap *= 2 );
+    }
+    fclose( f );
+
+    size_t     pos = 0;
+    while( pos < len && ( text[pos] == ' ' || text[pos] == '\r' || text[pos] == '\n' ) )
+        ++pos;
+
+    if( is_raw( path ) || pos == len || text[pos] != ':' )
+    {
+        open_scratch( size ? size : len );
+        memset( EeMmapStorage::image(), s_blank, EeStorage::size() );
+        memcpy( EeMmapStorage::image(), text, len < EeStorage::size() ? len : EeStorage::size() );
+        free( text );
+        return;
+    }
+
+    //  Two passes over the HEX: find the highest address, then copy.
+    for( int  pass = 0 ; pass < 2 ; ++pass )
+    {
+        unsigned long  upper = 0;
+        unsigned long  top = 0;
+        unsigned       lineno = 0;
+        const char *   p = (const char *) text;
+        const char *   end = p + len;
+
+        while( p < end )
+        {
+            const char *  eol = (const char *) memchr( p, '\n', end - p );
+            if( eol == NULL )
+                eol = end;
+            ++lineno;
+
+            const char *  q = p;
+            p = eol + 1;
+            while( q < eol && ( *q == ' ' || *q == '\r' ) )
+                ++q;
+            if( q == eol )
+                continue;
+
+            uint8_t   rec[5 + 255];
+            unsigned  n = 0;
+            uint8_t   sum = 0;
+
+            if( *q++ != ':' )
+                die( "%s:%u: not Intel HEX", path, lineno );
+            for( ; q + 1 < eol && hex_digit( q[0] ) >= 0 && hex_digit( q[1] ) >= 0 && n < sizeof(rec) ; q += 2 )
+                sum += rec[n++] = (uint8_t) (hex_digit( q[0] ) << 4 | hex_digit( q[1] ));
+
+            if( n < 5 || n != 5u + rec[0] || sum != 0 )
+                die( "%s:%u: bad Intel HEX record", path, lineno );
+
+            const unsigned long  addr = upper + ((unsigned) rec[1] << 8 | rec[2]);
+
+            if( rec[3] == 0 )
+            {
+                if( pass == 0 )
+                {
+                    if( addr + rec[0] > top )
+                        top = addr + rec[0];
+                }
+                else if( addr + rec[0] <= EeStorage::size() )
+                {
+                    memcpy( EeMmapStorage::image() + addr, rec + 4, rec[0] );
+                }
+                else
+                {
+                    die( "%s:%u: data past EEMEM size %lu", path, lineno, EeStorage::size() );
+                }
+            }
+            else if( rec[3] == 1 )
+                break;
+            else if( rec[3] == 2 && rec[0] == 2 )
+                upper = ((unsigned long) rec[4] << 8 | rec[5]) << 4;
+            else if( rec[3] == 4 && rec[0] == 2 )
+                upper = ((unsigned long) rec[4] << 8 | rec[5]) << 16;
+        }
+
+        if( pass == 0 )
+        {
+            open_scratch( size ? size : top );
+            memset( EeMmapStorage::image(), s_blank, EeStorage::size() );
+        }
+    }
+
+    free( text );
+}   /* end load_image() */
+
+/* ------------------------------------------------------------------- */
+
+/***
+ *   All records of the spec for 'unit' into a blank scratch EEMEM,
+ *   written by EeValues itself, so header, CRC and superblock entry are
+ *   exactly what the sketch would produce.
+ */
+static void
+build_unit( unsigned long unit )
+{
+    memset( EeMmapStorage::image(), s_blank, EeStorage::size() );
+
+    for( unsigned  i = 0 ; i < s_nrecords ; ++i )
+    {
+        const SpecRecord &  r = s_records[i];
+        EeValues            rec( r.ident );
+
+        encode_record( r, unit, NULL );
+        rec.setUserSize( r.user_size );
+        rec.setUserDataPtr( s_user );
+        rec.setEeOffset( (eeoffset_t) r.offset );
+#if EEVALUES_CONF_SCHEMA
+        rec.setSchema( r.schema );
+#endif
+        rec.updateCrc8();
+        rec.writeToEe();
+    }
+}
+
+
+static int
+cmd_build( const char * spec, const char * out, unsigned long count, unsigned long first )
+{
+    load_spec( spec );
+    open_scratch( s_size );
+
+    if( count > 1 && strstr( out, "%" ) == NULL )
+        die( "'%s' needs a %%u for the unit number", out );
+
+    char   path[1024];
+    const unsigned long long  t0 = now_ns();
+
+    for( unsigned long  unit = first ; unit < first + count ; ++unit )
+    {
+        build_unit( unit );
+        snprintf( path, sizeof(path), out, unit );
+        save_image( path );
+    }
+
+    const double  secs = ( now_ns() - t0 ) / 1e9;
+
+    printf( "%lu image%s of %lu bytes, %u records, in %.3f s ( %.0f images/s )\n",
+            count, count == 1 ? "" : "s", s_size, s_nrecords, secs, secs > 0 ? count / secs : 0.0 );
+    return( 0 );
+}   /* end cmd_build() */
+
+
+static void
+print_user( eeoffset_t off, unsigned n )
+{
+    const unsigned  shown = n < 16 ? n : 16;
+
+    EeStorage::readBlock( s_have, off, shown );
+    for( unsigned  i = 0 ; i < shown ; ++i )
+        printf( " %02X", s_have[i] );
+    printf( "%s   \"", n > shown ? " .." : "" );
+    for( unsigned  i = 0 ; i < shown ; ++i )
+        putchar( s_have[i] >= ' ' && s_have[i] <= '~' ? s_have[i] : '.' );
+    printf( "\"\n" );
+}
+
+
+static int
+cmd_dump( const char * image, unsigned long size )
+{
+    static EeDirEntry  table[255];
+    EeDirectory        dir( table, 255 );
+
+    load_image( image, size );
+    dir.scan( 0 );
+
+    printf( "  offset  ident       user  data\n" );
+
+    unsigned long  used = 0;
+
+    for( uint8_t  i = 0 ; i < dir.count() ; ++i )
+    {
+        const EeDirEntry &  e = dir.entry( i );
+
+        printf( "%8lu  %-10s %5u ", (unsigned long) e.m_offset, ident_text( e.m_ident ),
+                (unsigned) e.m_full_size - EeValues::HEADER_SIZE );
+        print_user( e.m_offset + EeValues::HEADER_SIZE, e.m_full_size - EeValues::HEADER_SIZE );
+        used += e.m_full_size;
+    }
+
+    printf( "%u record%s, %lu of %lu bytes%s\n", dir.count(), dir.count() == 1 ? "" : "s",
+            used, EeStorage::size(), dir.overflowed() ? " ; more than 255 records, list cut short" : "" );
+    return( 0 );
+}   /* end cmd_dump() */
+
+
+static int
+cmd_verify( const char * image, const char * spec, unsigned long unit )
+{
+    load_spec( spec );
+    load_image( image, s_size );
+
+    unsigned  bad = 0;
+
+    for( unsigned  i = 0 ; i < s_nrecords ; ++i )
+    {
+        const SpecRecord &  r = s_records[i];
+        EeValues            rec( r.ident );
+
+        encode_record( r, unit, s_care );
+        rec.setUserSize( r.user_size );
+        rec.setUserDataPtr( s_have );
+        rec.setEeOffset( 0 );
+#if EEVALUES_CONF_SCHEMA
+        rec.setSchema( r.schema );
+#endif
+
+        printf( "%-10s ", ident_text( r.ident ) );
+
+        if( ! rec.findHeader() )
+        {
+            printf( "BAD  not found\n" );
+            ++bad;
+            continue;
+        }
+        if( rec.eeOffsetOfHeader() != r.offset )
+        {
+            printf( "BAD  found at %lu, spec has %lu\n", (unsigned long) rec.eeOffsetOfHeader(), r.offset );
+            ++bad;
+            continue;
+        }
+
+        if( ! rec.loadIfValid() )
+        {
+            printf( "BAD  at %lu, header differs ( schema? )\n", r.offset );
+            ++bad;
+            continue;
+        }
+
+        unsigned  k = 0;
+        while( k < r.user_size && ( ! s_care[k] || s_have[k] == s_user[k] ) )
+            ++k;
+
+        if( k < r.user_size )
+        {
+            printf( "BAD  user byte %u is 0x%02X, spec has 0x%02X\n", k, s_have[k], s_user[k] );
+            ++bad;
+        }
+        else
+        {
+            printf( "ok   at %lu\n", r.offset );
+        }
+    }
+
+    return( bad ? 1 : 0 );
+}   /* end cmd_verify() */
+
+
+static int
+cmd_patch( const char * image, const char * ident, const char * offset,
+           char * const * fields, unsigned nfields, unsigned long unit, const char * out )
+{
+    static EeDirEntry  table[255];
+    EeDirectory        dir( table, 255 );
+
+    load_image( image, 0 );
+    dir.scan( 0 );
+
+    const EeIdent       id = parse_ident( ident );
+    const EeDirEntry *  e = dir.lookup( id );
+
+    if( e == NULL )
+        die( "%s: no valid record %s", image, ident_text( id ) );
+
+    const unsigned  user_size = e->m_full_size - EeValues::HEADER_SIZE;
+    unsigned        at = parse_number( offset, "user offset" );
+    EeValues        rec( id );
+
+    rec.setUserSize( user_size );
+    rec.setUserDataPtr( s_have );
+    rec.setEeOffset( e->m_offset );
+    rec.readToUser();
+
+    const unsigned  start = at;
+
+    for( unsigned  i = 0 ; i < nfields ; ++i )
+        encode_field( fields[i], unit, s_have, s_care, &at, user_size );
+    if( memchr( s_care + start, 0, at - start ) != NULL )
+        die( "serial fields need -u UNIT" );
+
+    unsigned  skipped = 0;
+
+    rec.updateCrc8();
+    rec.writeChangedToEe( &skipped );
+    save_image( out ? out : image );
+
+    printf( "%s at %lu: %lu bytes written\n", ident_text( id ), (unsigned long) e->m_offset,
+            EeMmapStorage::bytesWritten() );
+    return( 0 );
+}   /* end cmd_patch() */
+
+/* ------------------------------------------------------------------- */
+
+static void
+usage(void)
+{
+    fprintf( stderr,
+             "usage:  eeimage build  SPEC OUT [ -n COUNT ] [ -u FIRST ]\n"
+             "        eeimage dump   IMAGE [ -s SIZE ]\n"
+             "        eeimage verify IMAGE SPEC [ -u UNIT ]\n"
+             "        eeimage patch  IMAGE IDENT OFFSET FIELD... [ -u UNIT ] [ -o OUT ]\n" );
+    exit( 2 );
+}
+
+
+int
+main( int argc, char ** argv )
+{
+    char *         args[MAX_FIELDS + 4];
+    unsigned       nargs = 0;
+    unsigned long  count = 1;
+    unsigned long  unit = NO_UNIT;
+    unsigned long  size = 0;
+    const char *   out = NULL;
+
+    for( int  i = 1 ; i < argc ; ++i )
+    {
+        if( argv[i][0] == '-' && argv[i][1] != '\0' && argv[i][2] == '\0' && i + 1 < argc )
+        {
+            const char *  v = argv[++i];
+
+            switch( argv[i - 1][1] )
+            {
+              case 'n' :  count = parse_number( v, "count" );  break;
+              case 'u' :  unit = parse_number( v, "unit" );  break;
+              case 's' :  size = parse_number( v, "size" );  break;
+              case 'o' :  out = v;  break;
+              default :   usage();
+            }
+        }
+        else if( nargs < sizeof(args) / sizeof(args[0]) )
+        {
+            args[nargs++] = argv[i];
+        }
+        else
+        {
+            usage();
+        }
+    }
+
+    if( nargs == 3 && strcmp( args[0], "build" ) == 0 )
+        return cmd_build( args[1], args[2], count, unit == NO_UNIT ? 0 : unit );
+    if( nargs == 2 && strcmp( args[0], "dump" ) == 0 )
+        return cmd_dump( args[1], size );
+    if( nargs == 3 && strcmp( args[0], "verify" ) == 0 )
+        return cmd_verify( args[1], args[2], unit );
+    if( nargs >= 5 && strcmp( args[0], "patch" ) == 0 )
+        return cmd_patch( args[1], args[2], args[3], args + 4, nargs - 4, unit, out );
+
+    usage();
+    return( 2 );
+}   /* end main() */
@@ -0,0 +1,1012 @@
+/** eetorture.cpp ** Power-loss torture test of EeValues recovery **  Oct 2026 **/
+/*
+ *  For each scenario an image is set up holding a good copy of a record
+ *  among a few others.  Then, for every k from 0 to the number of bytes
+ *  the operation writes, the operation is run with power cut after k
+ *  byte writes ( see EeMmapStorage::cutPowerAfter() ).  The first write
+ *  that didn't land is torn in one of several ways: left alone, erased
+ *  to 0xFF, or set to a random value.  Then boot-time recovery runs.
+ *
+ *  Correctness:
+ *    - recovery may only accept the record as it was before or after
+ *      the operation, byte for byte ; anything else is 'bad' and fails,
+ *    - with redundancy ( EeShadow, EeRing, EeKv, EeBatch, and EeSchema
+ *      migrating through a spare ) it must
+ *      always find one ;
+ *      in-place scenarios just report how often the record was 'lost',
+ *    - with the operation complete, it must find the new record.
+ *
+ *  Cost: EEMEM bytes read and host time of the recovery call ( ident
+ *  scan, or ring / shadow search ), as min / median / p90 / max over all
+ *  torn images of a scenario.
+ *
+ *  Before the scenarios, writeChangedToEe()'s written and skipped counts
+ *  are checked against a model: the image a plain writeToEe() leaves,
+ *  compared byte for byte with the image before.
+ *
+ *  Built with EEVALUES_CONF_SUPERBLOCK, a record is also moved under the
+ *  cuts: every other superblock entry must survive, and recovery must
+ *  not write EEMEM.  First, a record kept below EeSuperblock::END must
+ *  survive writes that would otherwise format the superblock over it.
+ *
+ *  EeRecord is also checked to commit a whole record after it is moved,
+ *  invalidated or erased through the EeValues calls.
+ *
+ *  One JSON object per scenario on stdout ; exit status 1 if any failed.
+ *
+ *  usage:  eetorture [ image-file ]    default /tmp/eetorture.eep
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <EeValues.h>
+#include <EeRing.h>
+#include <EeRecord.h>
+#include <EeCompressed.h>
+#include <EeKv.h>
+#include <EeBatch.h>
+#include <EeSuperblock.h>
+#include <EeSchema.h>
+
+/* ------------------------------------------------------------------- */
+
+#define IMAGE_SIZE      1024
+#define REC_OFFSET      400
+#define REC_SIZE        24
+#define TORT_IDENT      MK4CODE('T','O','R','T')
+
+//  Tear modes per cut: clean, erased, then this many random values.
+#define RANDOM_TEARS    4
+#define TEAR_MODES      (2 + RANDOM_TEARS)
+
+#define MAX_TRIALS      4096
+
+enum Outcome { OUT_NEW, OUT_OLD, OUT_NONE, OUT_BAD };
+static const char * const  outcome_names[] = { "new", "old", "none", "bad" };
+
+struct Rec { uint8_t b[REC_SIZE]; };
+
+static const char *  s_path = "/tmp/eetorture.eep";
+
+static Rec           s_prev;            // before old, for redundant scenarios
+static Rec           s_old;
+static Rec           s_new;
+static uint8_t       s_snapshot[IMAGE_SIZE];
+
+/* ------------------------------------------------------------------- */
+
+static unsigned long long
+now_ns(void)
+{
+    struct timespec  ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+static void
+blank_image(void)
+{
+    memset( EeStorage::image(), 0xFF, EeStorage::size() );
+#if EEVALUES_CONF_CACHE_LINES
+    EeStorage::invalidate();
+#endif
+}
+
+
+//  A few other records, so the scan has something to step over.  The
+//  first goes past the superblock when there is one.
+#define FILLERS         4
+#define FILLER_IDENT(i) MK4CODE('F','I','L','0' + (i))
+
+#if EEVALUES_CONF_SUPERBLOCK
+static const eeoffset_t  s_filler_at[FILLERS] = { EeSuperblock::END, 150, 700, 850 };
+#else
+static const eeoffset_t  s_filler_at[FILLERS] = { 0, 150, 700, 850 };
+#endif
+
+static void
+write_fillers(void)
+{
+    uint8_t  fill[40];
+
+    for( unsigned  i = 0 ; i < FILLERS ; ++i )
+    {
+        EeValues  rec( FILLER_IDENT(i) );
+
+        memset( fill, 0x10 * i, sizeof(fill) );
+        rec.setUserDataPtr( fill );
+        rec.setUserSize( sizeof(fill) );
+        rec.setEeOffset( s_filler_at[i] );
+        rec.updateCrc8();
+        rec.writeToEe();
+    }
+}
+
+
+static Outcome
+classify( boolean found, const Rec & got )
+{
+    if( ! found )
+        return( OUT_NONE );
+    if( memcmp( &got, &s_new, sizeof(got) ) == 0 )
+        return( OUT_NEW );
+    if( memcmp( &got, &s_old, sizeof(got) ) == 0 )
+        return( OUT_OLD );
+    return( OUT_BAD );
+}
+
+/* ------------------------------------------------------------------- */
+
+//  In place, via EeValues: scan for it, and also check at known offset.
+
+static void
+plain_setup(void)
+{
+    Rec  r = s_old;
+    EeValues  rec( TORT_IDENT );
+
+    rec.setUserDataPtr( &r );
+    rec.setUserSize( sizeof(r) );
+    rec.setEeOffset( REC_OFFSET );
+    rec.updateCrc8();
+    rec.writeToEe();
+}
+
+static void
+plain_write(void)
+{
+    Rec  r = s_new;
+    EeValues  rec( TORT_IDENT );
+
+    rec.setUserDataPtr( &r );
+    rec.setUserSize( sizeof(r) );
+    rec.setEeOffset( REC_OFFSET );
+    rec.updateCrc8();
+    rec.writeToEe();
+}
+
+static void
+plain_write_changed(void)
+{
+    Rec  r = s_new;
+    EeValues  rec( TORT_IDENT );
+
+    rec.setUserDataPtr( &r );
+    rec.setUserSize( sizeof(r) );
+    rec.setEeOffset( REC_OFFSET );
+    rec.updateCrc8();
+    rec.writeChangedToEe();
+}
+
+static void
+plain_erase(void)
+{
+    Rec  r = s_old;
+    EeValues  rec( TORT_IDENT );
+
+    rec.setUserDataPtr( &r );
+    rec.setUserSize( sizeof(r) );
+    rec.setEeOffset( REC_OFFSET );
+    rec.eraseWholeRecord();
+}
+
+static void
+plain_invalidate(void)
+{
+    Rec  r = s_old;
+    EeValues  rec( TORT_IDENT );
+
+    rec.setUserDataPtr( &r );
+    rec.setUserSize( sizeof(r) );
+    rec.setEeOffset( REC_OFFSET );
+    rec.invalidate();
+}
+
+static Outcome
+plain_recover(void)
+{
+    Rec  got;
+    EeValues  rec( TORT_IDENT );
+
+    rec.setUserDataPtr( &got );
+    rec.setUserSize( sizeof(got) );
+    rec.setEeOffset( 0 );
+
+    const boolean  found = rec.findHeader();
+    if( found )
+        rec.readToUser();
+    const Outcome  scan = classify( found, got );
+
+    //  Known-offset path must not accept anything bad either.
+    Rec  at;
+    EeValues  fixed( TORT_IDENT );
+    fixed.setUserDataPtr( &at );
+    fixed.setUserSize( sizeof(at) );
+    fixed.setEeOffset( REC_OFFSET );
+    if( fixed.isHeaderValid() )
+    {
+        fixed.readToUser();
+        if( classify( true, at ) == OUT_BAD )
+            return( OUT_BAD );
+    }
+
+    return( scan );
+}
+
+/* ------------------------------------------------------------------- */
+
+//  EeRecord: dirty bytes, then CRC.
+
+typedef EeRecord< Rec, MK4CODE('T','R','E','C') >  TypedRec;
+
+static void
+record_setup(void)
+{
+    TypedRec  rec( REC_OFFSET );
+
+    rec.setBytes( 0, &s_old, sizeof(s_old) );
+    rec.commit();
+}
+
+static void
+record_commit(void)
+{
+    TypedRec  rec( REC_OFFSET );
+
+    rec.load();
+    rec.setBytes( 0, &s_new, sizeof(s_new) );
+    rec.commit();
+}
+
+static Outcome
+record_recover(void)
+{
+    TypedRec  rec( REC_OFFSET );
+
+    rec.setEeOffset( 0 );
+    const boolean  found = rec.findHeader() && rec.load();
+    return( classify( found, rec.get() ) );
+}
+
+/* ------------------------------------------------------------------- */
+
+//  EeCompressed: coded payload, pack info, header last.
+
+static void
+compressed_put( const Rec & src, boolean changed_only )
+{
+    Rec  r = src;
+    EeCompressed  rec( MK4CODE('T','C','M','P') );
+
+    rec.setUserDataPtr( &r );
+    rec.setUserSize( sizeof(r) );
+    rec.setEeOffset( REC_OFFSET );
+    rec.updateCrc8();
+    if( changed_only )
+        rec.writeChangedToEe();
+    else
+        rec.writeToEe();
+}
+
+static void  compressed_setup(void) { compressed_put( s_old, false ); }
+static void  compressed_write(void) { compressed_put( s_new, true ); }
+
+static Outcome
+compressed_recover(void)
+{
+    Rec  got;
+    EeCompressed  rec( MK4CODE('T','C','M','P') );
+
+    rec.setUserDataPtr( &got );
+    rec.setUserSize( sizeof(got) );
+    rec.setEeOffset( 0 );
+
+    const boolean  found = rec.findHeader() && rec.loadIfValid();
+    return( classify( found, got ) );
+}
+
+/* ------------------------------------------------------------------- */
+
+//  Redundant: EeShadow A/B and a 4 slot EeRing.
+
+static void
+ring_put( uint8_t slots, const Rec & src, boolean find_first )
+{
+    Rec  r = src;
+    EeRing  ring( TORT_IDENT, REC_OFFSET, slots );
+
+    ring.setUserDataPtr( &r );
+    ring.setUserSize( sizeof(r) );
+    if( find_first )
+        ring.findNewest();
+    ring.commit();
+}
+
+static void
+ring_setup( uint8_t slots )
+{
+    ring_put( slots, s_prev, false );
+    for( uint8_t  k = 1 ; k < slots ; ++k )
+        ring_put( slots, k + 1 == slots ? s_old : s_prev, true );
+}
+
+static Outcome
+ring_recover( uint8_t slots )
+{
+    Rec  got;
+    EeRing  ring( TORT_IDENT, REC_OFFSET, slots );
+
+    ring.setUserDataPtr( &got );
+    ring.setUserSize( sizeof(got) );
+
+    const boolean  found = ring.findNewest();
+    if( found )
+        ring.readToUser();
+    return( classify( found, got ) );
+}
+
+static void     shadow_setup(void) { ring_setup( 2 ); }
+static void     shadow_commit(void) { ring_put( 2, s_new, true ); }
+static Outcome  shadow_recover(void) { return ring_recover( 2 ); }
+
+/* ------------------------------------------------------------------- */
+
+//  Redundant: EeKv appends, and an append that has to compact first.
+
+#define KV_BASE         200
+#define KV_SIZE         500
+
+static EeDirEntry    s_kv_index[4];
+
+static void
+kv_put( const Rec & src )
+{
+    EeKv  kv( KV_BASE, KV_SIZE, s_kv_index, 4 );
+
+    kv.begin();
+    kv.put( TORT_IDENT, &src, sizeof(src) );
+}
+
+static void
+kv_setup(void)
+{
+    kv_put( s_prev );
+    kv_put( s_old );
+}
+
+//  Fill the bank with another key, so putting s_new must compact.
+static void
+kv_full_setup(void)
+{
+    EeKv  kv( KV_BASE, KV_SIZE, s_kv_index, 4 );
+    Rec   other;
+
+    kv.begin();
+    kv.put( TORT_IDENT, &s_prev, sizeof(s_prev) );
+    for( uint8_t  i = 0 ; kv.available() >= 2 * (EeValues::HEADER_SIZE + sizeof(Rec)) ; ++i )
+    {
+        memset( &other, i, sizeof(other) );
+        kv.put( MK4CODE('K','V','0','1'), &other, sizeof(other) );
+    }
+    kv.put( TORT_IDENT, &s_old, sizeof(s_old) );
+}
+
+static void
+kv_commit(void)
+{
+    kv_put( s_new );
+}
+
+static Outcome
+kv_recover(void)
+{
+    Rec   got;
+    EeKv  kv( KV_BASE, KV_SIZE, s_kv_index, 4 );
+
+    const boolean  found = kv.begin() && kv.get( TORT_IDENT, &got, sizeof(got) ) == (int) sizeof(got);
+    return( classify( found, got ) );
+}
+
+//  Redundant: EeBatch commits the record as three parts of 8 bytes, each
+//  its own EeValues record.  A mix of old and new parts is 'bad'.
+
+#define BATCH_PARTS     3
+#define BATCH_JOURNAL   500
+#define BATCH_JSIZE     150
+
+static const eeoffset_t  s_part_at[BATCH_PARTS] = { 220, 270, 320 };
+
+static void
+batch_put( const Rec & src )
+{
+    Rec          r = src;
+    EeValues *   table[BATCH_PARTS];
+    EeBatch      batch( BATCH_JOURNAL, BATCH_JSIZE, table, BATCH_PARTS );
+    EeValues     a( MK4CODE('T','B','A','0') );
+    EeValues     b( MK4CODE('T','B','A','1') );
+    EeValues     c( MK4CODE('T','B','A','2') );
+    EeValues *   parts[BATCH_PARTS] = { &a, &b, &c };
+
+    for( uint8_t  i = 0 ; i < BATCH_PARTS ; ++i )
+    {
+        parts[i]->setUserDataPtr( r.b + i * (REC_SIZE / BATCH_PARTS) );
+        parts[i]->setUserSize( REC_SIZE / BATCH_PARTS );
+        parts[i]->setEeOffset( s_part_at[i] );
+    }
+
+    //  Out of address order: commit() sorts them.
+    batch.add( c );
+    batch.add( a );
+    batch.add( b );
+    batch.commit();
+}
+
+static void     batch_setup(void) { batch_put( s_prev ); batch_put( s_old ); }
+static void     batch_commit(void) { batch_put( s_new ); }
+
+static Outcome
+batch_recover(void)
+{
+    Rec      got;
+    boolean  found = true;
+
+    EeBatch::recover( BATCH_JOURNAL, BATCH_JSIZE );
+
+    for( uint8_t  i = 0 ; i < BATCH_PARTS ; ++i )
+    {
+        EeValues  p( MK4CODE('T','B','A','0' + i) );
+
+        p.setUserDataPtr( got.b + i * (REC_SIZE / BATCH_PARTS) );
+        p.setUserSize( REC_SIZE / BATCH_PARTS );
+        p.setEeOffset( s_part_at[i] );
+        found = p.loadIfValid() && found;
+    }
+
+    return( classify( found, got ) );
+}
+
+/* ------------------------------------------------------------------- */
+
+//  Record moved to a new offset, which moves its superblock entry.
+//  Recovery must find every filler's entry still good, and find the
+//  record without writing EEMEM.  Needs an entry beyond the fillers'.
+
+#if EEVALUES_CONF_SUPERBLOCK > FILLERS
+
+#define SB_MOVED_OFFSET 500
+
+static void
+sb_put( eeoffset_t at, const Rec & src )
+{
+    Rec       r = src;
+    EeValues  rec( TORT_IDENT );
+
+    rec.setUserDataPtr( &r );
+    rec.setUserSize( sizeof(r) );
+    rec.setEeOffset( at );
+    rec.updateCrc8();
+    rec.writeToEe();
+}
+
+static void     sb_setup(void) { sb_put( REC_OFFSET, s_old ); }
+static void     sb_move(void) { sb_put( SB_MOVED_OFFSET, s_new ); }
+
+static Outcome
+sb_recover(void)
+{
+    for( unsigned  i = 0 ; i < FILLERS ; ++i )
+    {
+        EeSuperblock::Entry  ent;
+
+        if( ! EeSuperblock::lookup( FILLER_IDENT(i), &ent ) || ent.m_offset != s_filler_at[i] )
+            return( OUT_BAD );
+    }
+
+    Rec       got;
+    EeValues  rec( TORT_IDENT );
+
+    rec.setUserDataPtr( &got );
+    rec.setUserSize( sizeof(got) );
+
+    const boolean  found = rec.findHeader() && rec.loadIfValid();
+
+    if( EeStorage::bytesWritten() > 0 )
+        return( OUT_BAD );
+
+    return( classify( found, got ) );
+}
+
+#endif  /* EEVALUES_CONF_SUPERBLOCK > FILLERS */
+
+/* ------------------------------------------------------------------- */
+
+//  Record of the last 20 bytes of 's_new', migrated to all 24 through a
+//  spare: the first 4 are defaults.  Recovery is loadOrMigrate() again,
+//  so every cut must end with the migrated record.
+
+#define MIGRATE_SPARE   950
+#define MIGRATE_KEPT    (REC_SIZE - 4)
+
+static const EeFieldMap   s_migrate_fields[] PROGMEM = { { 0, 4, MIGRATE_KEPT } };
+static const EeMigration  s_migrate_steps[] PROGMEM = { { 0, MIGRATE_KEPT, s_migrate_fields, 1 } };
+
+static void
+migrate_setup(void)
+{
+    Rec       r = s_new;
+    EeValues  rec( TORT_IDENT );
+
+    rec.setUserDataPtr( r.b + 4 );
+    rec.setUserSize( MIGRATE_KEPT );
+    rec.setEeOffset( REC_OFFSET );
+    rec.updateCrc8();
+    rec.writeToEe();
+}
+
+static boolean
+migrate_load( Rec * r )
+{
+    EeValues  rec( TORT_IDENT );
+
+    memset( r->b, 0xAA, sizeof(r->b) );
+    memcpy( r->b, s_new.b, 4 );
+    rec.setUserDataPtr( r );
+    rec.setUserSize( sizeof(*r) );
+    rec.setEeOffset( REC_OFFSET );
+#if EEVALUES_CONF_SCHEMA
+    rec.setSchema( 1 );
+#endif
+    return( EeSchema::loadOrMigrate( rec, s_migrate_steps, 1, MIGRATE_SPARE ) >= 0 );
+}
+
+static void     migrate_run(void) { Rec  r; migrate_load( &r ); }
+
+static Outcome
+migrate_recover(void)
+{
+    Rec  got;
+    const boolean  found = migrate_load( &got );
+    return( classify( found, got ) );
+}
+
+static void     ring4_setup(void) { ring_setup( 4 ); }
+static void     ring4_commit(void) { ring_put( 4, s_new, true ); }
+static Outcome  ring4_recover(void) { return ring_recover( 4 ); }
+
+/* ------------------------------------------------------------------- */
+
+struct Scenario
+{
+    const char *    name;
+    boolean         redundant;          // must never lose the record
+    boolean         erases;             // "new" state is no record at all
+    void         (* setup)(void);
+    void         (* operate)(void);
+    Outcome      (* recover)(void);
+};
+
+static const Scenario  scenarios[] =
+{
+    { "writeToEe",        false, false, plain_setup,      plain_write,         plain_recover },
+    { "writeChangedToEe", false, false, plain_setup,      plain_write_changed, plain_recover },
+    { "eraseWholeRecord", false, true,  plain_setup,      plain_erase,         plain_recover },
+    { "invalidate",       false, true,  plain_setup,      plain_invalidate,    plain_recover },
+    { "EeRecord::commit", false, false, record_setup,     record_commit,       record_recover },
+    { "EeCompressed",     false, false, compressed_setup, compressed_write,    compressed_recover },
+    { "EeShadow",         true,  false, shadow_setup,     shadow_commit,       shadow_recover },
+    { "EeRing4",          true,  false, ring4_setup,      ring4_commit,        ring4_recover },
+    { "EeKv::put",        true,  false, kv_setup,         kv_commit,           kv_recover },
+    { "EeKv::compact",    true,  false, kv_full_setup,    kv_commit,           kv_recover },
+    { "EeBatch::commit",  true,  false, batch_setup,      batch_commit,        batch_recover },
+    { "EeSchema::spare",  true,  false, migrate_setup,    migrate_run,         migrate_recover },
+#if EEVALUES_CONF_SUPERBLOCK > FILLERS
+    { "EeSuperblock",     true,  false, sb_setup,         sb_move,             sb_recover },
+#endif
+};
+
+
+//  writeChangedToEe() from the current image, checked against a model:
+//  writeToEe() of the same record from the same image.  Bytes written
+//  must be those that differ, counted by the call and by the back-end ;
+//  all others skipped.
+static boolean
+check_changed( const char * name, const Rec & src )
+{
+    static uint8_t  before[IMAGE_SIZE];
+    static uint8_t  model[IMAGE_SIZE];
+    Rec       r = src;
+    EeValues  rec( TORT_IDENT );
+
+    rec.setUserDataPtr( &r );
+    rec.setUserSize( sizeof(r) );
+    rec.setEeOffset( REC_OFFSET );
+    rec.updateCrc8();
+
+    memcpy( before, EeStorage::image(), IMAGE_SIZE );
+    rec.writeToEe();
+    memcpy( model, EeStorage::image(), IMAGE_SIZE );
+
+    memcpy( EeStorage::image(), before, IMAGE_SIZE );
+#if EEVALUES_CONF_CACHE_LINES
+    EeStorage::invalidate();
+#endif
+
+    unsigned  skipped = 0;
+    EeStorage::resetCounters();
+    const int  written = rec.writeChangedToEe( &skipped );
+    const unsigned long  counted = EeStorage::bytesWritten();
+
+    //  The back-end also counts a superblock entry moving ; the call
+    //  counts the record's bytes only.
+    unsigned  differ = 0;
+    unsigned  differ_all = 0;
+    for( unsigned  i = 0 ; i < IMAGE_SIZE ; ++i )
+    {
+        differ_all += before[i] != model[i];
+        differ += before[i] != model[i] && i >= REC_OFFSET && i < REC_OFFSET + rec.totalSize();
+    }
+
+    const boolean  ok = memcmp( EeStorage::image(), model, IMAGE_SIZE ) == 0 &&
+                        written == (int) differ && counted == differ_all &&
+                        skipped == rec.totalSize() - differ;
+
+    printf( "{\"check\":\"writeChangedToEe\",\"case\":\"%s\",\"written\":%d,\"skipped\":%u,"
+            "\"expect_written\":%u,\"expect_skipped\":%u,\"ok\":%s}\n",
+            name, written, skipped, differ, rec.totalSize() - differ, ok ? "true" : "false" );
+    return( ok );
+}
+
+static boolean
+check_write_counts(void)
+{
+    Rec      r;
+    boolean  ok = true;
+
+    blank_image();
+    write_fillers();
+
+    ok = check_changed( "blank", s_old ) && ok;
+    ok = check_changed( "same", s_old ) && ok;
+
+    r = s_old;
+    r.b[0] ^= 0x01;
+    r.b[REC_SIZE - 1] ^= 0x80;
+    ok = check_changed( "two_bytes", r ) && ok;
+
+    ok = check_changed( "every_byte", s_new ) && ok;
+
+    //  Half the user bytes already hold the new values.
+    r = s_prev;
+    memcpy( r.b, s_new.b, REC_SIZE / 2 );
+    ok = check_changed( "half", r ) && ok;
+
+    return( ok );
+}
+
+
+//  EeRecord commits after the record is moved or erased through the
+//  EeValues calls must leave a whole, valid record, not dirty bytes
+//  over nothing.
+static boolean
+check_record_resync(void)
+{
+    static const eeoffset_t  moved = 600;
+    TypedRec  rec( REC_OFFSET );
+    TypedRec  back( moved );
+    boolean   ok = true;
+
+    blank_image();
+    write_fillers();
+
+    rec.setBytes( 0, &s_old, sizeof(s_old) );
+    rec.commit();
+    ok = rec.load() && ok;
+
+    rec.setEeOffset( moved );
+    rec.set( &Rec::b, s_new.b );
+    rec.commit();
+    ok = back.load() && memcmp( &back.get(), &s_new, sizeof(s_new) ) == 0 && ok;
+
+    rec.invalidate();
+    rec.setBytes( 0, &s_old, sizeof(s_old) );
+    rec.commit();
+    ok = back.load() && memcmp( &back.get(), &s_old, sizeof(s_old) ) == 0 && ok;
+
+    rec.eraseWholeRecord();
+    rec.setBytes( 0, &s_new, sizeof(s_new) );
+    rec.commit();
+    ok = back.load() && memcmp( &back.get(), &s_new, sizeof(s_new) ) == 0 && ok;
+
+    printf( "{\"check\":\"EeRecord_resync\",\"ok\":%s}\n", ok ? "true" : "false" );
+    return( ok );
+}
+
+
+//  Retiring an EeRing must retire every slot: if only the newest went,
+//  findNewest() would bring back the one before it.
+static boolean
+check_ring_retire(void)
+{
+    boolean  ok = true;
+
+    blank_image();
+    write_fillers();
+
+    ring_setup( 4 );
+    {
+        EeRing  ring( TORT_IDENT, REC_OFFSET, 4 );
+        ring.setUserSize( sizeof(Rec) );
+        ok = ring.findNewest() && ring.invalidate() == 4 && ok;
+    }
+    ok = ring_recover( 4 ) == OUT_NONE && ok;
+
+    ring_setup( 4 );
+    {
+        EeRing  ring( TORT_IDENT, REC_OFFSET, 4 );
+        ring.setUserSize( sizeof(Rec) );
+        ring.eraseWholeRecord();
+    }
+    ok = ring_recover( 4 ) == OUT_NONE && ok;
+
+    printf( "{\"check\":\"EeRing_retire\",\"ok\":%s}\n", ok ? "true" : "false" );
+    return( ok );
+}
+
+
+#if EEVALUES_CONF_SCHEMA
+
+//  EeCompressed and EeRing, like EeValues, must refuse a record stored
+//  with another schema, so EeSchema gets to migrate it.
+static boolean
+check_schema_match(void)
+{
+    Rec      r = s_old;
+    Rec      got;
+    boolean  ok = true;
+
+    blank_image();
+    write_fillers();
+
+    for( uint8_t  schema = 1 ; schema <= 2 ; ++schema )
+    {
+        EeCompressed  packed( MK4CODE('T','C','M','P') );
+        packed.setUserDataPtr( &r );
+        packed.setUserSize( sizeof(r) );
+        packed.setEeOffset( REC_OFFSET );
+        packed.setSchema( 1 );
+        packed.updateCrc8();
+        packed.writeToEe();
+
+        EeCompressed  back( MK4CODE('T','C','M','P') );
+        back.setUserDataPtr( &got );
+        back.setUserSize( sizeof(got) );
+        back.setEeOffset( REC_OFFSET );
+        back.setSchema( schema );
+        ok = back.loadIfValid() == ( schema == 1 ) && ok;
+    }
+
+    ring_setup( 4 );
+    for( uint8_t  schema = 0 ; schema <= 1 ; ++schema )
+    {
+        EeRing  ring( TORT_IDENT, REC_OFFSET, 4 );
+        ring.setUserDataPtr( &got );
+        ring.setUserSize( sizeof(got) );
+        ring.setSchema( schema );
+        ok = ring.findNewest() == ( schema == 0 ) && ok;
+    }
+
+    printf( "{\"check\":\"schema_match\",\"ok\":%s}\n", ok ? "true" : "false" );
+    return( ok );
+}
+
+#endif  /* EEVALUES_CONF_SCHEMA */
+
+
+#if EEVALUES_CONF_SUPERBLOCK
+
+//  Record at 'at' with 'src' ; true if it then loads back intact.
+static boolean
+below_put( eeoffset_t at, const Rec & src )
+{
+    Rec       r = src;
+    Rec       got;
+    EeValues  rec( TORT_IDENT );
+
+    rec.setUserDataPtr( &r );
+    rec.setUserSize( sizeof(r) );
+    rec.setEeOffset( at );
+    rec.updateCrc8();
+    rec.writeToEe();
+
+    EeValues  back( TORT_IDENT );
+    back.setUserDataPtr( &got );
+    back.setUserSize( sizeof(got) );
+    back.setEeOffset( at );
+    return( back.isHeaderValid() && back.loadIfValid() && memcmp( &got, &src, sizeof(got) ) == 0 );
+}
+
+//  Records a sketch kept below EeSuperblock::END before turning the
+//  superblock on: writing one, or any other record, must not format
+//  the superblock over it.
+static boolean
+check_below_superblock(void)
+{
+    static const eeoffset_t  below = 10;
+    static const eeoffset_t  other = 600;
+    boolean  ok = true;
+    Rec      got;
+
+    blank_image();
+    ok = below_put( below, s_old ) && ok;
+    ok = ! EeSuperblock::isFormatted() && ok;
+
+    //  Another record elsewhere: its entry needs the superblock.
+    EeValues  rec( TORT_IDENT );
+    rec.setUserDataPtr( &got );
+    rec.setUserSize( sizeof(got) );
+
+    EeValues  second( MK4CODE('T','O','R','2') );
+    second.setUserDataPtr( &got );
+    second.setUserSize( sizeof(got) );
+    second.setEeOffset( other );
+    got = s_new;
+    second.updateCrc8();
+    second.writeToEe();
+
+    ok = ! EeSuperblock::isFormatted() && ok;
+    ok = rec.findHeader() && rec.eeOffsetOfHeader() == below && rec.loadIfValid() &&
+         memcmp( &got, &s_old, sizeof(got) ) == 0 && ok;
+    ok = ! EeSuperblock::repair( rec ) && ok;
+
+    //  Once the record moves past END, the superblock can go in.
+    rec.invalidate();
+    ok = below_put( REC_OFFSET, s_new ) && ok;
+    ok = EeSuperblock::isFormatted() && ok;
+
+    printf( "{\"check\":\"below_superblock\",\"at\":%u,\"end\":%u,\"ok\":%s}\n",
+            (unsigned) below, (unsigned) EeSuperblock::END, ok ? "true" : "false" );
+    return( ok );
+}
+
+#endif  /* EEVALUES_CONF_SUPERBLOCK */
+
+
+static int
+cmp_ulong( const void * a, const void * b )
+{
+    const unsigned long  x = *(const unsigned long *) a;
+    const unsigned long  y = *(const unsigned long *) b;
+    return( x < y ? -1 : x > y );
+}
+
+//  "name":{"min":..,"p50":..,"p90":..,"max":..} of 'n' sorted values.
+static void
+print_spread( const char * name, unsigned long * v, unsigned n, double scale )
+{
+    qsort( v, n, sizeof(*v), cmp_ulong );
+    printf( ",\"%s\":{\"min\":%.1f,\"p50\":%.1f,\"p90\":%.1f,\"max\":%.1f}", name,
+            v[0] / scale, v[n / 2] / scale, v[(n * 9) / 10] / scale, v[n - 1] / scale );
+}
+
+
+static boolean
+run_scenario( const Scenario & sc )
+{
+    static unsigned long  reads[MAX_TRIALS];
+    static unsigned long  ns[MAX_TRIALS];
+    unsigned long  counts[4] = { 0, 0, 0, 0 };
+    unsigned       trials = 0;
+    boolean        complete_ok = true;
+
+    blank_image();
+    write_fillers();
+    sc.setup();
+    memcpy( s_snapshot, EeStorage::image(), IMAGE_SIZE );
+
+    //  Dry run to learn how many bytes the operation writes.
+    EeStorage::resetCounters();
+    sc.operate();
+    const unsigned long  total = EeStorage::bytesWritten();
+
+    srand( 1 );
+
+    for( unsigned long  k = 0 ; k <= total ; ++k )
+    {
+        for( unsigned  mode = 0 ; mode < (k < total ? TEAR_MODES : 1) ; ++mode )
+        {
+            memcpy( EeStorage::image(), s_snapshot, IMAGE_SIZE );
+#if EEVALUES_CONF_CACHE_LINES
+            EeStorage::invalidate();
+#endif
+
+            EeStorage::cutPowerAfter( k );
+            sc.operate();
+            EeStorage::powerRestore();
+
+            eeoffset_t  off;
+            uint8_t     value;
+            if( EeStorage::powerLost( &off, &value ) && mode > 0 )
+                EeStorage::image()[off] = mode == 1 ? 0xFF : (uint8_t) rand();
+#if EEVALUES_CONF_CACHE_LINES
+            EeStorage::invalidate();
+#endif
+
+            EeStorage::resetCounters();
+            const unsigned long long  t0 = now_ns();
+            Outcome  out = sc.recover();
+            const unsigned long long  t = now_ns() - t0;
+
+            //  After an erase, "no record" is the new state.
+            if( sc.erases && out == OUT_NEW )
+                out = OUT_BAD;
+            if( sc.erases && out == OUT_NONE )
+                out = OUT_NEW;
+
+            ++counts[out];
+            if( k == total && out != OUT_NEW )
+                complete_ok = false;
+
+            if( trials < MAX_TRIALS )
+            {
+                reads[trials] = EeStorage::bytesRead();
+                ns[trials] = (unsigned long) t;
+                ++trials;
+            }
+        }
+    }
+
+    const boolean  ok = counts[OUT_BAD] == 0 && complete_ok &&
+                        ! (sc.redundant && counts[OUT_NONE] > 0);
+
+    printf( "{\"scenario\":\"%s\",\"crc\":%u,\"bytes_written\":%lu,\"trials\":%u,\"redundant\":%s",
+            sc.name, (unsigned) EEVALUES_CONF_CRC, total, trials, sc.redundant ? "true" : "false" );
+    for( int  o = OUT_NEW ; o <= OUT_BAD ; ++o )
+        printf( ",\"%s\":%lu", o == OUT_NONE ? "lost" : outcome_names[o], counts[o] );
+    print_spread( "recovery_reads", reads, trials, 1.0 );
+    print_spread( "recovery_us", ns, trials, 1000.0 );
+    printf( ",\"ok\":%s}\n", ok ? "true" : "false" );
+
+    return( ok );
+}
+
+
+int
+main( int argc, char ** argv )
+{
+    if( argc > 1 )
+        s_path = argv[1];
+
+    if( ! EeStorage::open( s_path, IMAGE_SIZE ) )
+    {
+        fprintf( stderr, "eetorture: can't map %s\n", s_path );
+        return( 2 );
+    }
+
+    //  Every byte differs between versions, so a torn mix can't pass as
+    //  either.  Long runs, so EeCompressed really codes them.
+    for( unsigned  i = 0 ; i < REC_SIZE ; ++i )
+    {
+        s_prev.b[i] = i < 6 ? (uint8_t) (0x40 + i) : 0x55;
+        s_old.b[i] = i < 6 ? (uint8_t) (0x80 + i) : 0x00;
+        s_new.b[i] = i < 6 ? (uint8_t) (0xC0 + i) : 0xFF;
+    }
+
+    boolean  all_ok = check_write_counts();
+    all_ok = check_record_resync() && all_ok;
+    all_ok = check_ring_retire() && all_ok;
+#if EEVALUES_CONF_SCHEMA
+    all_ok = check_schema_match() && all_ok;
+#endif
+#if EEVALUES_CONF_SUPERBLOCK
+    all_ok = check_below_superblock() && all_ok;
+#endif
+
+    for( unsigned  i = 0 ; i < sizeof(scenarios) / sizeof(scenarios[0]) ; ++i )
+        all_ok = run_scenario( scenarios[i] ) && all_ok;
+
+    EeStorage::close();
+    return( all_ok ? 0 : 1 );
+}